@@ -9,20 +9,15 @@ void Map::loadFromXML(XmlReader &xr) {
     return;
   }
 
-  _grid = std::vector<std::vector<char> >(_w);
-  for (auto &col : _grid) {
-    col = std::vector<char>(_h, '\0');
-  }
+  _tiles = std::vector<char>(_w * _h, '\0');
 
   for (auto row : xr.getChildren("row")) {
     size_t y;
     if (!xr.findAttr(row, "y", y) || y >= _h) break;
     std::string rowTerrain;
     if (!xr.findAttr(row, "terrain", rowTerrain)) break;
-    for (size_t x = 0; x != rowTerrain.size(); ++x) {
-      if (x > _w) break;
-      _grid[x][y] = rowTerrain[x];
-    }
+    auto length = min(rowTerrain.size(), _w);
+    rowTerrain.copy(&_tiles[to1D(0, y)], length);
   }
 }
 
@@ -71,7 +66,7 @@ std::set<char> Map::terrainTypesOverlapping(const MapRect &rect,
     size_t tileLeft = getCol(rect.x, tileTop),
            tileRight = getCol(right, tileTop);
     for (size_t x = tileLeft; x <= tileRight; ++x)
-      tilesInRect.insert(_grid[x][tileTop]);
+      tilesInRect.insert(at(x, tileTop));
 
     // General case
   } else {
@@ -84,7 +79,7 @@ std::set<char> Map::terrainTypesOverlapping(const MapRect &rect,
       if (tileRight < tileLeft) return tilesInRect;
 
       for (size_t x = tileLeft; x <= tileRight; ++x) {
-        char terrainIndex = _grid[x][y];
+        char terrainIndex = at(x, y);
         // Exclude if outside radius
         if (extraRadius != 0) {
           if (tilesInRect.find(terrainIndex) != tilesInRect.end()) continue;
@@ -100,7 +95,7 @@ std::set<char> Map::terrainTypesOverlapping(const MapRect &rect,
 char Map::getTerrainAtPoint(const MapPoint &p) const {
   auto row = getRow(p.y);
   auto col = getCol(p.x, row);
-  return _grid[col][row];
+  return at(col, row);
 }
 
 MapPoint Map::randomPoint() const {
@@ -108,8 +103,13 @@ MapPoint Map::randomPoint() const {
 }
 
 MapPoint Map::randomPointInTile(size_t x, size_t y) {
+  return randomPointInTile(x, y, randDouble);
+}
+
+MapPoint Map::randomPointInTile(size_t x, size_t y,
+                                const std::function<double()> &random) {
   auto tile = getTileRect(x, y);
-  return {tile.x + randDouble() * tile.w, tile.y + randDouble() * tile.h};
+  return {tile.x + random() * tile.w, tile.y + random() * tile.h};
 }
 
 size_t Map::to1D(size_t x, size_t y) const { return _w * y + x; }
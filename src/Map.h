@@ -1,5 +1,6 @@
 #pragma once
 
+#include <functional>
 #include <vector>
 
 #include "Point.h"
@@ -14,8 +15,7 @@ class Map {
   size_t width() const { return _w; }
   size_t height() const { return _h; }
 
-  const std::vector<char>& operator[](size_t x) const { return _grid[x]; }
-  std::vector<char>& operator[](size_t x) { return _grid[x]; }
+  char at(size_t x, size_t y) const { return _tiles[_w * y + x]; }
 
   size_t getRow(double yCoord) const;
   size_t getCol(double xCoord, size_t row) const;
@@ -26,11 +26,13 @@ class Map {
 
   MapPoint randomPoint() const;
   static MapPoint randomPointInTile(size_t x, size_t y);
+  static MapPoint randomPointInTile(size_t x, size_t y,
+                                    const std::function<double()>& random);
 
   size_t to1D(size_t x, size_t y) const;
   std::pair<size_t, size_t> from1D(size_t i) const;
 
  private:
-  std::vector<std::vector<char> > _grid;
+  std::vector<char> _tiles;  // Row-major, as indexed by to1D()
   size_t _w{0}, _h{0};
 };
@@ -18,6 +18,10 @@ class Serial {
   bool isInventory() const { return _raw == INVENTORY; }
   bool isGear() const { return _raw == GEAR; }
 
+  // For compact storage of serials that were generated earlier.
+  size_t raw() const { return _raw; }
+  static Serial FromRaw(size_t raw) { return {raw}; }
+
  private:
   Serial(size_t n) { _raw = n; }
   size_t _raw;
@@ -32,7 +32,10 @@ XmlReader::~XmlReader() { _doc.Clear(); }
 bool XmlReader::newString(const std::string &data) {
   _doc.Clear();
   _root = nullptr;
-  if (!_doc.Parse(data.c_str() /*, 0, TIXML_ENCODING_UTF8*/)) return false;
+  // Parse() returns null for a document that ends with its root's end tag, so
+  // success is judged as LoadFile() judges it.
+  _doc.Parse(data.c_str() /*, 0, TIXML_ENCODING_UTF8*/);
+  if (_doc.Error()) return false;
   _root = _doc.FirstChildElement();
   return *this;
 }
@@ -56,6 +59,16 @@ XmlReader::Elements XmlReader::getChildren(const std::string &val,
   return children;
 }
 
+XmlReader::Elements XmlReader::getAllChildren(TiXmlElement *elem) {
+  if (elem == nullptr) return {};
+
+  auto children = Elements{};
+  for (TiXmlElement *child = elem->FirstChildElement(); child;
+       child = child->NextSiblingElement())
+    children.push_back(child);
+  return children;
+}
+
 TiXmlElement *XmlReader::findChild(const std::string &val, TiXmlElement *elem) {
   if (elem == nullptr) return nullptr;
 
@@ -26,6 +26,7 @@ class XmlReader {
   XmlReader(const std::string &string, bool isFile);
 
  public:
+  XmlReader() {}  // Empty, until newFile() or newString()
   static XmlReader FromString(const std::string &data);
   static XmlReader FromFile(const std::string &filename);
   ~XmlReader();
@@ -43,6 +44,8 @@ class XmlReader {
   Elements getChildren(const std::string &val) {
     return getChildren(val, _root);
   }
+  static Elements getAllChildren(TiXmlElement *elem);  // In document order
+  Elements getAllChildren() { return getAllChildren(_root); }
   static TiXmlElement *findChild(const std::string &val, TiXmlElement *elem);
   TiXmlElement *findChild(const std::string &val) {
     return findChild(val, _root);
@@ -0,0 +1,138 @@
+#include "XmlStreamWriter.h"
+
+#include <cstdio>
+#include <cstdlib>
+
+XmlStreamWriter::XmlStreamWriter(const std::string &filename, Layout layout)
+    : _filename(filename), _layout(layout) {
+  if (_layout == DOCUMENT) _text = "<root>\n";
+}
+
+XmlStreamWriter XmlStreamWriter::Document(const std::string &filename) {
+  return XmlStreamWriter(filename, DOCUMENT);
+}
+
+XmlStreamWriter XmlStreamWriter::Records(const std::string &filename) {
+  return XmlStreamWriter(filename, RECORDS);
+}
+
+void XmlStreamWriter::startLine() {
+  if (_layout == RECORDS) return;
+  // One level for the root, and one for each open element
+  _text.append(4 * (_openElements.size() + 1), ' ');
+}
+
+void XmlStreamWriter::endLine() {
+  if (_layout == RECORDS && !_openElements.empty()) return;
+  _text.push_back('\n');
+}
+
+void XmlStreamWriter::openElement(const char *name) {
+  if (_startTagIsOpen) {
+    _text.push_back('>');
+    endLine();
+  }
+  startLine();
+  _text.push_back('<');
+  _text.append(name);
+  _openElements.push_back(name);
+  _startTagIsOpen = true;
+  _hasElements = true;
+}
+
+void XmlStreamWriter::closeElement() {
+  if (_openElements.empty()) return;
+  const auto name = std::move(_openElements.back());
+  _openElements.pop_back();
+
+  if (_startTagIsOpen)
+    _text.append(" />");
+  else {
+    startLine();
+    _text.append("</");
+    _text.append(name);
+    _text.push_back('>');
+  }
+  _startTagIsOpen = false;
+  endLine();
+}
+
+void XmlStreamWriter::startAttr(const char *name) {
+  _text.push_back(' ');
+  _text.append(name);
+  _text.append("=\"");
+}
+
+void XmlStreamWriter::setAttr(const char *name, const std::string &value) {
+  setAttr(name, value.c_str());
+}
+
+void XmlStreamWriter::setAttr(const char *name, const char *value) {
+  startAttr(name);
+  appendEscaped(value);
+  _text.push_back('"');
+}
+
+void XmlStreamWriter::setAttr(const char *name, double value) {
+  startAttr(name);
+  // As short as it can be while still reading back as the same value
+  char buffer[32];
+  auto length = snprintf(buffer, sizeof(buffer), "%.15g", value);
+  if (strtod(buffer, nullptr) != value)
+    length = snprintf(buffer, sizeof(buffer), "%.17g", value);
+  _text.append(buffer, length);
+  _text.push_back('"');
+}
+
+void XmlStreamWriter::appendUnsigned(unsigned long long value,
+                                     bool isNegative) {
+  char digits[24];
+  auto *end = digits + sizeof(digits);
+  auto *start = end;
+  do {
+    *--start = static_cast<char>('0' + value % 10);
+    value /= 10;
+  } while (value > 0);
+  if (isNegative) *--start = '-';
+  _text.append(start, end);
+}
+
+void XmlStreamWriter::appendEscaped(const char *value) {
+  for (auto *c = value; *c != '\0'; ++c) {
+    switch (*c) {
+      case '&':
+        _text.append("&amp;");
+        break;
+      case '<':
+        _text.append("&lt;");
+        break;
+      case '>':
+        _text.append("&gt;");
+        break;
+      case '"':
+        _text.append("&quot;");
+        break;
+      case '\'':
+        _text.append("&apos;");
+        break;
+      // Literal line breaks and tabs may be normalised to spaces by readers,
+      // and a line break would also split a record across two lines.
+      case '\n':
+        _text.append("&#10;");
+        break;
+      case '\r':
+        _text.append("&#13;");
+        break;
+      case '\t':
+        _text.append("&#9;");
+        break;
+      default:
+        _text.push_back(*c);
+    }
+  }
+}
+
+std::string XmlStreamWriter::contents() const {
+  if (_layout == RECORDS) return _text;
+  return _text + "</root>\n";
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// Writes XML text as it is described, without building a document in memory
+// first.  Elements must be described in the order they appear in the output:
+// each is opened, given its attributes, then given its children, then closed.
+// Numbers are formatted directly, without iostreams.
+//
+// A document is laid out like XmlWriter's, under a <root> element.  Records
+// have no root: each top-level element takes up a single line, so that a
+// line cut short by a crash affects only its own element.
+class XmlStreamWriter {
+ public:
+  static XmlStreamWriter Document(const std::string &filename);
+  static XmlStreamWriter Records(const std::string &filename);
+
+  const std::string &filename() const { return _filename; }
+  bool isEmpty() const { return !_hasElements; }
+
+  void openElement(const char *name);
+  void closeElement();  // The innermost open one
+
+  // Attributes belong to the element most recently opened, and must precede
+  // its children.
+  void setAttr(const char *name, const std::string &value);
+  void setAttr(const char *name, const char *value);
+  void setAttr(const char *name, double value);
+  template <typename T>
+  typename std::enable_if<std::is_integral<T>::value>::type setAttr(
+      const char *name, T value) {
+    startAttr(name);
+    if (value < 0)
+      appendUnsigned(0 - static_cast<unsigned long long>(value), true);
+    else
+      appendUnsigned(static_cast<unsigned long long>(value), false);
+    _text.push_back('"');
+  }
+
+  std::string contents() const;  // Every element must have been closed.
+
+ private:
+  enum Layout { DOCUMENT, RECORDS };
+  XmlStreamWriter(const std::string &filename, Layout layout);
+
+  void startAttr(const char *name);
+  void appendUnsigned(unsigned long long value, bool isNegative);
+  void appendEscaped(const char *value);
+  void startLine();
+  void endLine();
+
+  std::string _filename;
+  Layout _layout;
+  std::string _text;
+  std::vector<std::string> _openElements;
+  bool _startTagIsOpen{false};  // Still accepting attributes
+  bool _hasElements{false};
+};
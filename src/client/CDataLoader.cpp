@@ -5,6 +5,7 @@
 #include "../Podes.h"
 #include "../TerrainList.h"
 #include "../XmlReader.h"
+#include "../parallel.h"
 #include "ClassInfo.h"
 #include "Client.h"
 #include "ClientBuff.h"
@@ -46,35 +47,38 @@ void CDataLoader::load(bool keepOldData) {
 
   auto usingPath = !_path.empty();
   if (usingPath) {
-    _files = getXMLFiles(_path, "map.xml"s);
-
-    loadFromAllFiles(&CDataLoader::loadTerrain);
-    loadFromAllFiles(&CDataLoader::loadTerrainLists);
-    loadFromAllFiles(&CDataLoader::loadMapPins);
-    loadFromAllFiles(&CDataLoader::loadCompositeStats);
-    loadFromAllFiles(&CDataLoader::loadParticles);
-    loadFromAllFiles(&CDataLoader::loadSounds);
-    loadFromAllFiles(&CDataLoader::loadProjectiles);
-    loadFromAllFiles(&CDataLoader::loadSpells);
-    loadFromAllFiles(&CDataLoader::loadBuffs);
-
-    for (const auto &file : _files) {
-      auto xr = XmlReader::FromFile(file);
-      _client.gameData.tagNames.readFromXML(xr);
-    }
-
-    loadFromAllFiles(&CDataLoader::loadObjectTypes);
-    loadFromAllFiles(&CDataLoader::loadItems);
-    loadFromAllFiles(&CDataLoader::loadPermanentObjects);
-    loadFromAllFiles(&CDataLoader::loadClasses);
-    loadFromAllFiles(&CDataLoader::loadRecipes);
-    loadFromAllFiles(&CDataLoader::loadNPCTemplates);
-    loadFromAllFiles(&CDataLoader::loadNPCTypes);
-    loadFromAllFiles(&CDataLoader::loadQuests);
+    // Each file is parsed once, and the map alongside the rest.
+    const auto xmlFiles = getXMLFiles(_path, "map.xml"s);
+    auto filenames = std::vector<std::string>{xmlFiles.begin(), xmlFiles.end()};
+    filenames.push_back(_path + "/map.xml");
+    auto documents = parseFiles(filenames);
+    auto map = std::move(documents.back());
+    documents.pop_back();
+
+    loadFromAllFiles(documents, &CDataLoader::loadTerrain);
+    loadFromAllFiles(documents, &CDataLoader::loadTerrainLists);
+    loadFromAllFiles(documents, &CDataLoader::loadMapPins);
+    loadFromAllFiles(documents, &CDataLoader::loadCompositeStats);
+    loadFromAllFiles(documents, &CDataLoader::loadParticles);
+    loadFromAllFiles(documents, &CDataLoader::loadSounds);
+    loadFromAllFiles(documents, &CDataLoader::loadProjectiles);
+    loadFromAllFiles(documents, &CDataLoader::loadSpells);
+    loadFromAllFiles(documents, &CDataLoader::loadBuffs);
+
+    for (const auto &xr : documents)
+      if (*xr) _client.gameData.tagNames.readFromXML(*xr);
+
+    loadFromAllFiles(documents, &CDataLoader::loadObjectTypes);
+    loadFromAllFiles(documents, &CDataLoader::loadItems);
+    loadFromAllFiles(documents, &CDataLoader::loadPermanentObjects);
+    loadFromAllFiles(documents, &CDataLoader::loadClasses);
+    loadFromAllFiles(documents, &CDataLoader::loadRecipes);
+    loadFromAllFiles(documents, &CDataLoader::loadNPCTemplates);
+    loadFromAllFiles(documents, &CDataLoader::loadNPCTypes);
+    loadFromAllFiles(documents, &CDataLoader::loadQuests);
 
     _client.drawLoadingScreen("Loading map");
-    auto reader = XmlReader::FromFile(_path + "/map.xml");
-    loadMap(reader);
+    loadMap(*map);
   } else {
     auto reader = XmlReader::FromString(_data);
     if (!reader) {
@@ -104,12 +108,23 @@ void CDataLoader::load(bool keepOldData) {
   _client._dataLoaded = true;
 }
 
-void CDataLoader::loadFromAllFiles(LoadFunction load) {
-  for (const auto &file : _files) {
-    auto xr = XmlReader::FromFile(file);
-    if (!xr) continue;
-    (this->*load)(xr);
-  }
+CDataLoader::Documents CDataLoader::parseFiles(
+    const std::vector<std::string> &filenames) const {
+  auto documents = Documents(filenames.size());
+  parallelFor(
+      filenames.size(),
+      [&](size_t i) {
+        documents[i] = std::make_unique<XmlReader>();
+        documents[i]->newFile(filenames[i]);
+      },
+      "Data parser");
+  return documents;
+}
+
+void CDataLoader::loadFromAllFiles(const Documents &documents,
+                                   LoadFunction load) {
+  for (const auto &xr : documents)
+    if (*xr) (this->*load)(*xr);
 }
 
 void CDataLoader::loadTerrain(XmlReader &xr) {
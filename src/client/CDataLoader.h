@@ -1,7 +1,8 @@
 #pragma once
 
-#include <set>
+#include <memory>
 #include <string>
+#include <vector>
 
 class Client;
 class XmlReader;
@@ -43,9 +44,10 @@ class CDataLoader {
   Directory _path;
   XML _data;
 
+  // Every data file is parsed once, up front, in parallel, into documents in
+  // the same order as the filenames; each pass then walks the result.
+  using Documents = std::vector<std::unique_ptr<XmlReader>>;
+  Documents parseFiles(const std::vector<std::string> &filenames) const;
   using LoadFunction = void (CDataLoader::*)(XmlReader &);
-  void loadFromAllFiles(LoadFunction load);
-
-  using FilesList = std::set<std::string>;
-  FilesList _files;
+  void loadFromAllFiles(const Documents &documents, LoadFunction load);
 };
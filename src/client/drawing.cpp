@@ -222,7 +222,7 @@ void Client::drawFootprint(const MapRect &rect, Color color,
 
 void Client::drawTile(size_t x, size_t y, px_t xLoc, px_t yLoc) const {
   if (isDebug()) {
-    gameData.terrain.at(_map[x][y]).draw(xLoc, yLoc);
+    gameData.terrain.at(_map.at(x, y)).draw(xLoc, yLoc);
     return;
   }
 
@@ -234,29 +234,29 @@ void Client::drawTile(size_t x, size_t y, px_t xLoc, px_t yLoc) const {
   const ScreenRect drawLoc(xLoc, yLoc, 0, 0);
   const bool yOdd = (y % 2 == 1);
   char tileID, L, R, E, F, G, H;
-  tileID = _map[x][y];
-  R = x == _map.width() - 1 ? tileID : _map[x + 1][y];
-  L = x == 0 ? tileID : _map[x - 1][y];
+  tileID = _map.at(x, y);
+  R = x == _map.width() - 1 ? tileID : _map.at(x + 1, y);
+  L = x == 0 ? tileID : _map.at(x - 1, y);
   if (y == 0) {
     H = E = tileID;
   } else {
     if (yOdd) {
-      E = _map[x][y - 1];
-      H = x == 0 ? tileID : _map[x - 1][y - 1];
+      E = _map.at(x, y - 1);
+      H = x == 0 ? tileID : _map.at(x - 1, y - 1);
     } else {
-      E = x == _map.width() - 1 ? tileID : _map[x + 1][y - 1];
-      H = _map[x][y - 1];
+      E = x == _map.width() - 1 ? tileID : _map.at(x + 1, y - 1);
+      H = _map.at(x, y - 1);
     }
   }
   if (y == _map.height() - 1) {
     G = F = tileID;
   } else {
     if (!yOdd) {
-      F = x == _map.width() - 1 ? tileID : _map[x + 1][y + 1];
-      G = _map[x][y + 1];
+      F = x == _map.width() - 1 ? tileID : _map.at(x + 1, y + 1);
+      G = _map.at(x, y + 1);
     } else {
-      F = _map[x][y + 1];
-      G = x == 0 ? tileID : _map[x - 1][y + 1];
+      F = _map.at(x, y + 1);
+      G = x == 0 ? tileID : _map.at(x - 1, y + 1);
     }
   }
 
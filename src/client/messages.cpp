@@ -2869,6 +2869,7 @@ void Client::initializeMessageNames() {
   _messageCommands["spells"] = DG_SPELLS;
   _messageCommands["die"] = DG_DIE;
   _messageCommands["simulateYields"] = DG_SIMULATE_YIELDS;
+  _messageCommands["reloadData"] = DG_RELOAD_DATA;
 
   _errorMessages[WARNING_TOO_FAR] =
       "You are too far away to perform that action.";
@@ -914,6 +914,9 @@ enum MessageCode {
   // Arguments: object-type ID
   DG_SIMULATE_YIELDS,
 
+  // "Reload any game data that has changed"
+  DG_RELOAD_DATA,
+
   // Messages used in tests
 
   // Tell the client to send the message back to the server; used for remote
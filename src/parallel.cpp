@@ -0,0 +1,35 @@
+#include "parallel.h"
+
+#ifndef SINGLE_THREAD
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "threadNaming.h"
+#endif
+
+void parallelFor(size_t count, const std::function<void(size_t)> &task,
+                 const char *threadName) {
+#ifdef SINGLE_THREAD
+  for (auto i = size_t{0}; i != count; ++i) task(i);
+#else
+  const auto numCores = std::max(std::thread::hardware_concurrency(), 1u);
+  const auto numThreads = std::min<size_t>(count, numCores);
+
+  std::atomic<size_t> next{0};
+  auto work = [&]() {
+    for (auto i = next++; i < count; i = next++) task(i);
+  };
+
+  // This thread does its share too.
+  auto threads = std::vector<std::thread>{};
+  for (auto i = size_t{1}; i < numThreads; ++i)
+    threads.emplace_back([&]() {
+      setThreadName(threadName);
+      work();
+    });
+  work();
+  for (auto &thread : threads) thread.join();
+#endif
+}
@@ -0,0 +1,10 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+
+// Call task(0) to task(count - 1), spread across up to one thread per core.
+// The calls may happen in any order, so each must touch only its own data.
+// Returns once every call has.
+void parallelFor(size_t count, const std::function<void(size_t)> &task,
+                 const char *threadName);
@@ -5,11 +5,42 @@
 #include "Server.h"
 #include "User.h"
 
-AI::AI(NPC &owner) : _owner(owner), _activePath(owner) {
+extern Args cmdLineArgs;
+
+AI::AI(NPC &owner)
+    : _owner(owner),
+      _isAlwaysAtFullRate(cmdLineArgs.contains("ai-at-full-rate")),
+      _activePath(owner) {
   _homeLocation = _owner.location();
 }
 
+void AI::update(ms_t timeElapsed) {
+  _timeSinceProcessed += timeElapsed;
+  const auto isEngaged = state != IDLE || !_owner._threatTable.isEmpty();
+  if (!isEngaged && _timeSinceProcessed < _processingInterval) return;
+
+  process(_timeSinceProcessed);
+  _timeSinceProcessed = 0;
+  _processingInterval = chooseProcessingInterval();
+}
+
+ms_t AI::chooseProcessingInterval() const {
+  if (state != IDLE) return 0;
+  if (_isAlwaysAtFullRate) return 0;
+
+  const auto &server = Server::instance();
+  const auto location = _owner.location();
+  if (!server.findUsersInArea(location, Server::CULL_DISTANCE).empty())
+    return 0;
+  if (!server.findUsersInArea(location, 2 * Server::CULL_DISTANCE).empty())
+    return INTERVAL_WHEN_NEARBY;
+  return INTERVAL_WHEN_DISTANT;
+}
+
 void AI::process(ms_t timeElapsed) {
+  ++_timesProcessed;
+  _lastTimeProcessedFor = timeElapsed;
+
   _owner.target(nullptr);
 
   _owner.getNewTargetsFromProximity(timeElapsed);
@@ -53,7 +84,7 @@ void AI::transitionIfNecessary() {
         if (ownerPlayer == nullptr) break;
         if (distance(*ownerPlayer, _owner) <= FOLLOW_DISTANCE) break;
         state = PET_FOLLOW_OWNER;
-        _owner._followTarget = ownerPlayer;
+        _owner.followTarget(ownerPlayer);
         break;
       }
 
@@ -75,12 +106,18 @@ void AI::transitionIfNecessary() {
         break;
       }
 
-      const auto distanceFromOwner = distance(*_owner._followTarget, _owner);
+      // Owner has logged off
+      if (!_owner.followTarget()) {
+        state = IDLE;
+        break;
+      }
+
+      const auto distanceFromOwner = distance(*_owner.followTarget(), _owner);
 
       // Owner is close enough
       if (distanceFromOwner <= AI::FOLLOW_DISTANCE) {
         state = IDLE;
-        _owner._followTarget = nullptr;
+        _owner.followTarget(nullptr);
         break;
       }
 
@@ -95,7 +132,7 @@ void AI::transitionIfNecessary() {
           if (ownerPlayer) ownerPlayer->followers.remove();
         }
 
-        _owner._followTarget = nullptr;
+        _owner.followTarget(nullptr);
         break;
       }
       break;
@@ -259,6 +296,7 @@ void AI::act() {
 void AI::giveOrder(PetOrder newOrder) {
   order = newOrder;
   _homeLocation = _owner.location();
+  _owner.markAsChanged();
 
   // Send order confirmation to owner
   auto owner = _owner.permissions.getPlayerOwner();
@@ -24,7 +24,14 @@ class AI {
     ORDER_TO_FOLLOW
   } order{ORDER_TO_FOLLOW};  // A desire; informs pet actions
 
+  // Idle NPCs away from users are processed less often, with the time in
+  // between accumulated.  Engaged NPCs, and those users can see, are
+  // processed every tick.  The "ai-at-full-rate" argument disables this.
+  static const ms_t INTERVAL_WHEN_NEARBY{250}, INTERVAL_WHEN_DISTANT{1000};
+  void update(ms_t timeElapsed);
   void process(ms_t timeElapsed);
+  size_t timesProcessed() const { return _timesProcessed; }
+  ms_t lastTimeProcessedFor() const { return _lastTimeProcessedFor; }
 
   void giveOrder(AI::PetOrder newOrder);
   PetOrder currentOrder() const { return order; }
@@ -33,6 +40,13 @@ class AI {
   NPC &_owner;
 
   MapPoint _homeLocation;  // Where it returns after a chase.
+
+  ms_t chooseProcessingInterval() const;
+  const bool _isAlwaysAtFullRate;
+  ms_t _processingInterval{0};
+  ms_t _timeSinceProcessed{0};
+  size_t _timesProcessed{0};
+  ms_t _lastTimeProcessedFor{0};
   std::mutex _pathfindingMutex;
 
   void transitionIfNecessary();
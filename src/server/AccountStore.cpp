@@ -0,0 +1,310 @@
+#include "AccountStore.h"
+
+#include <io.h>
+#include <sys/stat.h>
+#include <windows.h>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+#include "Server.h"
+#include "checksum.h"
+
+namespace {
+
+const char MAGIC[4] = {'A', 'C', 'C', 'T'};
+const uint32_t VERSION = 1;
+
+#pragma pack(push, 1)
+struct FileHeader {
+  char magic[4];
+  uint32_t version;
+};
+
+// Followed by the name, then the contents
+struct RecordHeader {
+  uint32_t nameLength;
+  uint32_t contentsLength;
+  int64_t timeWritten;
+  uint32_t checksum;  // Of everything after the header
+};
+#pragma pack(pop)
+
+uint32_t recordChecksum(const std::string &name, const std::string &contents) {
+  return checksum(contents.data(), contents.size(),
+                  checksum(name.data(), name.size()));
+}
+
+void appendRecord(std::string &buffer, const std::string &name,
+                  const std::string &contents, time_t timeWritten) {
+  auto header = RecordHeader{};
+  header.nameLength = static_cast<uint32_t>(name.size());
+  header.contentsLength = static_cast<uint32_t>(contents.size());
+  header.timeWritten = timeWritten;
+  header.checksum = recordChecksum(name, contents);
+  buffer.append(reinterpret_cast<const char *>(&header), sizeof(header));
+  buffer.append(name);
+  buffer.append(contents);
+}
+
+bool writeAndFlush(FILE *file, const std::string &buffer) {
+  if (fwrite(buffer.data(), 1, buffer.size(), file) != buffer.size())
+    return false;
+  if (fflush(file) != 0) return false;
+  return _commit(_fileno(file)) == 0;
+}
+
+}  // namespace
+
+AccountStore::~AccountStore() { closeFile(); }
+
+uint64_t AccountStore::recordSize(const std::string &name,
+                                  const IndexEntry &entry) {
+  return sizeof(RecordHeader) + name.size() + entry.contentsLength;
+}
+
+void AccountStore::open(const std::string &filename) {
+  auto lock = std::unique_lock<std::mutex>{_mutex};
+  closeFile();
+  _filename = filename;
+  _file = fopen(_filename.c_str(), "r+b");
+  if (_file)
+    buildIndex();
+  else
+    createEmptyFile();
+}
+
+void AccountStore::clear() {
+  auto lock = std::unique_lock<std::mutex>{_mutex};
+  closeFile();
+  createEmptyFile();
+}
+
+void AccountStore::closeFile() {
+  if (_file) fclose(_file);
+  _file = nullptr;
+  _index.clear();
+  _fileSize = 0;
+  _liveSize = 0;
+}
+
+void AccountStore::createEmptyFile() {
+  _file = fopen(_filename.c_str(), "w+b");
+  if (!_file) {
+    Server::debug()("Failed to create account store "s + _filename,
+                    Color::CHAT_ERROR);
+    return;
+  }
+
+  auto header = FileHeader{};
+  memcpy(header.magic, MAGIC, sizeof(MAGIC));
+  header.version = VERSION;
+  auto buffer = std::string{reinterpret_cast<const char *>(&header),
+                            sizeof(header)};
+  writeAndFlush(_file, buffer);
+  _fileSize = sizeof(header);
+}
+
+void AccountStore::buildIndex() {
+  auto &debug = Server::debug();
+
+  _fseeki64(_file, 0, SEEK_END);
+  auto contents = std::string(static_cast<size_t>(_ftelli64(_file)), '\0');
+  _fseeki64(_file, 0, SEEK_SET);
+  fread(&contents[0], 1, contents.size(), _file);
+
+  auto header = FileHeader{};
+  if (contents.size() < sizeof(header)) {
+    closeFile();
+    createEmptyFile();
+    return;
+  }
+  memcpy(&header, contents.data(), sizeof(header));
+  if (memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 ||
+      header.version != VERSION) {
+    debug("Account store "s + _filename + " is not in a known format"s,
+          Color::CHAT_ERROR);
+    closeFile();
+    return;
+  }
+
+  // Scan the records, stopping at the first that is incomplete or damaged
+  auto pos = uint64_t{sizeof(header)};
+  while (pos < contents.size()) {
+    auto record = RecordHeader{};
+    if (contents.size() - pos < sizeof(record)) break;
+    memcpy(&record, contents.data() + pos, sizeof(record));
+    const auto bodyLength =
+        uint64_t{record.nameLength} + uint64_t{record.contentsLength};
+    if (contents.size() - pos - sizeof(record) < bodyLength) break;
+    const auto *body = contents.data() + pos + sizeof(record);
+    if (checksum(body, static_cast<size_t>(bodyLength)) != record.checksum)
+      break;
+
+    auto name = std::string(body, record.nameLength);
+    auto it = _index.find(name);
+    if (it != _index.end()) _liveSize -= recordSize(name, it->second);
+    auto entry = IndexEntry{pos, record.contentsLength,
+                            static_cast<time_t>(record.timeWritten)};
+    _liveSize += recordSize(name, entry);
+    _index[name] = entry;
+
+    pos += sizeof(record) + bodyLength;
+  }
+  _fileSize = pos;
+
+  if (_fileSize < contents.size()) {
+    debug << Color::CHAT_ERROR << "Account store " << _filename
+          << ": discarding a damaged record at the end of the file"
+          << Log::endl;
+    _chsize_s(_fileno(_file), static_cast<__int64>(_fileSize));
+  }
+}
+
+bool AccountStore::contains(const std::string &name) const {
+  auto lock = std::unique_lock<std::mutex>{_mutex};
+  return _index.count(name) == 1;
+}
+
+bool AccountStore::read(const std::string &name, std::string &contents) const {
+  auto lock = std::unique_lock<std::mutex>{_mutex};
+  auto it = _index.find(name);
+  if (it == _index.end()) return false;
+
+  const auto &entry = it->second;
+  const auto contentsOffset = entry.offset + sizeof(RecordHeader) + name.size();
+  if (_fseeki64(_file, static_cast<__int64>(contentsOffset), SEEK_SET) != 0)
+    return false;
+  contents.resize(entry.contentsLength);
+  return fread(&contents[0], 1, contents.size(), _file) == contents.size();
+}
+
+bool AccountStore::write(const Accounts &accounts) {
+  auto lock = std::unique_lock<std::mutex>{_mutex};
+  if (!_file) return false;
+
+  const auto now = time(nullptr);
+  auto buffer = std::string{};
+  auto newEntries = std::vector<IndexEntry>{};
+  newEntries.reserve(accounts.size());
+  for (const auto &account : accounts) {
+    const auto timeWritten = account.timeWritten ? account.timeWritten : now;
+    newEntries.push_back({_fileSize + buffer.size(),
+                          static_cast<uint32_t>(account.contents.size()),
+                          timeWritten});
+    appendRecord(buffer, account.name, account.contents, timeWritten);
+  }
+
+  _fseeki64(_file, static_cast<__int64>(_fileSize), SEEK_SET);
+  if (!writeAndFlush(_file, buffer)) {
+    // Leave the file as it was, so that it isn't extended by a partial record
+    _chsize_s(_fileno(_file), static_cast<__int64>(_fileSize));
+    Server::debug()("Failed to write to account store "s + _filename,
+                    Color::CHAT_ERROR);
+    return false;
+  }
+  _fileSize += buffer.size();
+
+  for (auto i = size_t{0}; i != accounts.size(); ++i) {
+    const auto &name = accounts[i].name;
+    auto it = _index.find(name);
+    if (it != _index.end()) _liveSize -= recordSize(name, it->second);
+    _liveSize += recordSize(name, newEntries[i]);
+    _index[name] = newEntries[i];
+  }
+
+  const auto isMostlySuperseded = _liveSize * 2 < _fileSize;
+  if (_fileSize >= MIN_SIZE_TO_COMPACT && isMostlySuperseded) compact();
+
+  return true;
+}
+
+AccountStore::TimesWritten AccountStore::timesWritten() const {
+  auto lock = std::unique_lock<std::mutex>{_mutex};
+  auto times = TimesWritten{};
+  for (const auto &pair : _index) times[pair.first] = pair.second.timeWritten;
+  return times;
+}
+
+void AccountStore::compact() {
+  const auto startTime = SDL_GetTicks();
+  const auto oldSize = _fileSize;
+
+  // Copy the latest record of each account into a new file
+  auto header = FileHeader{};
+  memcpy(header.magic, MAGIC, sizeof(MAGIC));
+  header.version = VERSION;
+  auto buffer =
+      std::string{reinterpret_cast<const char *>(&header), sizeof(header)};
+  buffer.reserve(static_cast<size_t>(sizeof(header) + _liveSize));
+  auto newIndex = _index;
+  for (auto &pair : newIndex) {
+    const auto &name = pair.first;
+    auto &entry = pair.second;
+    auto record = std::string(static_cast<size_t>(recordSize(name, entry)), 0);
+    _fseeki64(_file, static_cast<__int64>(entry.offset), SEEK_SET);
+    if (fread(&record[0], 1, record.size(), _file) != record.size()) return;
+    entry.offset = buffer.size();
+    buffer.append(record);
+  }
+
+  const auto tempFilename = _filename + ".tmp";
+  auto *tempFile = fopen(tempFilename.c_str(), "wb");
+  if (!tempFile) return;
+  const auto wasWritten = writeAndFlush(tempFile, buffer);
+  fclose(tempFile);
+  if (!wasWritten) return;
+
+  fclose(_file);
+  _file = nullptr;
+  if (!MoveFileExA(tempFilename.c_str(), _filename.c_str(),
+                   MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH)) {
+    Server::debug()("Failed to compact account store "s + _filename,
+                    Color::CHAT_ERROR);
+    _file = fopen(_filename.c_str(), "r+b");
+    return;
+  }
+
+  _file = fopen(_filename.c_str(), "r+b");
+  _index = std::move(newIndex);
+  _fileSize = buffer.size();
+
+  auto of = std::ofstream{"accountCompaction.log", std::ios_base::app};
+  of << oldSize                            // File size before (bytes)
+     << "," << _fileSize                   // File size after (bytes)
+     << "," << _index.size()               // Accounts
+     << "," << SDL_GetTicks() - startTime  // Time taken (ms)
+     << std::endl;
+}
+
+size_t AccountStore::importUserFiles(const std::string &directory) {
+  auto path = directory;
+  std::replace(path.begin(), path.end(), '/', '\\');
+  const auto filter = path + "*.usr";
+
+  auto accounts = Accounts{};
+  WIN32_FIND_DATA fd;
+  HANDLE hFind = FindFirstFile(filter.c_str(), &fd);
+  if (hFind != INVALID_HANDLE_VALUE) {
+    do {
+      auto filename = std::string{fd.cFileName};
+      auto account = Account{};
+      account.name = filename.substr(0, filename.size() - 4);
+      auto file = std::ifstream{path + filename, std::ios_base::binary};
+      auto oss = std::ostringstream{};
+      oss << file.rdbuf();
+      account.contents = oss.str();
+      struct stat info;
+      if (stat((path + filename).c_str(), &info) == 0)
+        account.timeWritten = info.st_mtime;
+      accounts.push_back(std::move(account));
+    } while (FindNextFile(hFind, &fd));
+    FindClose(hFind);
+  }
+
+  if (accounts.empty()) return 0;
+  if (!write(accounts)) return 0;
+  return accounts.size();
+}
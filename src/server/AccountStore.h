@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <ctime>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Every user's saved data, in one append-only file.  Each write appends a
+// record holding the user's name and the full text of their data, and an index
+// in memory maps each name to its latest record; reading an account is one
+// seek and one read.  Superseded records stay where they are until they make up
+// most of the file, which is then compacted by copying the live records to a
+// new file and renaming it over the old one.
+//
+// Every record carries a checksum.  The file is scanned when it is opened, to
+// build the index; a damaged or incomplete record at the end, left by a crash
+// while appending, is cut off, so that account keeps its previous version.
+class AccountStore {
+ public:
+  struct Account {
+    std::string name, contents;
+    time_t timeWritten{0};  // 0: now
+  };
+  using Accounts = std::vector<Account>;
+  using TimesWritten = std::map<std::string, time_t>;  // Name -> time written
+
+  ~AccountStore();
+
+  void open(const std::string &filename);
+  void clear();  // Delete every account
+  // Copy in users' data from the old format: one XML file per user, named
+  // <user>.usr.  Accounts already in the store are replaced.
+  size_t importUserFiles(const std::string &directory);
+
+  bool contains(const std::string &name) const;
+  bool read(const std::string &name, std::string &contents) const;
+  // Appended together, and flushed to the disk once.  False on failure, in
+  // which case none of them are written.
+  bool write(const Accounts &accounts);
+  TimesWritten timesWritten() const;  // Every account, from the index
+
+ private:
+  static const uint64_t MIN_SIZE_TO_COMPACT = 1024 * 1024;
+
+  struct IndexEntry {
+    uint64_t offset;  // Of the record's header
+    uint32_t contentsLength;
+    time_t timeWritten;
+  };
+  static uint64_t recordSize(const std::string &name, const IndexEntry &entry);
+
+  void createEmptyFile();
+  void buildIndex();
+  void compact();
+  void closeFile();
+
+  mutable std::mutex _mutex;
+  std::string _filename;
+  FILE *_file{nullptr};
+  std::map<std::string, IndexEntry> _index;
+  uint64_t _fileSize{0};
+  uint64_t _liveSize{0};  // Bytes taken up by the latest record of each account
+};
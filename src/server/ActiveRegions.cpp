@@ -0,0 +1,56 @@
+#include "ActiveRegions.h"
+
+#include "../Args.h"
+
+extern Args cmdLineArgs;
+
+const px_t ActiveRegions::REGION_SIZE = 1000;
+const px_t ActiveRegions::ACTIVATION_DISTANCE = 1000;
+const px_t ActiveRegions::DEACTIVATION_DISTANCE = 1500;
+
+ActiveRegions::ActiveRegions()
+    : _allAreActive(cmdLineArgs.contains("all-regions-active")) {}
+
+void ActiveRegions::update(const std::vector<MapPoint> &userLocations) {
+  auto active = std::set<Region>{};
+  auto stillNeeded = std::set<Region>{};
+  for (const auto &location : userLocations) {
+    const auto margin = MapPoint{static_cast<double>(DEACTIVATION_DISTANCE),
+                                 static_cast<double>(DEACTIVATION_DISTANCE)};
+    const auto first = regionContaining(location - margin),
+               last = regionContaining(location + margin);
+    for (auto y = first.second; y <= last.second; ++y)
+      for (auto x = first.first; x <= last.first; ++x) {
+        const auto region = Region{x, y};
+        const auto distanceToUser =
+            distance(rectOf(region), MapRect{location});
+        if (distanceToUser <= ACTIVATION_DISTANCE) active.insert(region);
+        if (distanceToUser <= DEACTIVATION_DISTANCE)
+          stillNeeded.insert(region);
+      }
+  }
+
+  for (const auto &region : _active)
+    if (stillNeeded.count(region) == 1) active.insert(region);
+  _active.swap(active);
+}
+
+bool ActiveRegions::isActive(const MapPoint &location) const {
+  if (_allAreActive) return true;
+  return _active.count(regionContaining(location)) == 1;
+}
+
+ActiveRegions::Region ActiveRegions::regionContaining(
+    const MapPoint &location) {
+  auto toRegion = [](double coordinate) {
+    if (coordinate < 0) return size_t{0};
+    return static_cast<size_t>(coordinate / REGION_SIZE);
+  };
+  return {toRegion(location.x), toRegion(location.y)};
+}
+
+MapRect ActiveRegions::rectOf(const Region &region) {
+  return {static_cast<double>(region.first * REGION_SIZE),
+          static_cast<double>(region.second * REGION_SIZE),
+          static_cast<double>(REGION_SIZE), static_cast<double>(REGION_SIZE)};
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "../Point.h"
+
+// The map is divided into square regions, each active only while a user is
+// nearby.  NPCs in inactive regions are left as they are, and spawners there
+// hold back their respawns until the region is next active, so that the work
+// done scales with the parts of the world that users are in rather than with
+// its size.
+//
+// A region becomes active when a user comes within ACTIVATION_DISTANCE of it,
+// and stays active until no user is within DEACTIVATION_DISTANCE, so that a
+// user near a border doesn't toggle it back and forth.  Everywhere is active
+// if the server is run with "all-regions-active".
+class ActiveRegions {
+ public:
+  static const px_t REGION_SIZE, ACTIVATION_DISTANCE, DEACTIVATION_DISTANCE;
+
+  ActiveRegions();
+
+  void update(const std::vector<MapPoint> &userLocations);
+  bool isActive(const MapPoint &location) const;
+  size_t numActive() const { return _active.size(); }
+
+ private:
+  using Region = std::pair<size_t, size_t>;  // x, y
+  static Region regionContaining(const MapPoint &location);
+  static MapRect rectOf(const Region &region);
+
+  std::set<Region> _active;
+  const bool _allAreActive;
+};
@@ -0,0 +1,298 @@
+#include "BinaryWorldFile.h"
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <unordered_map>
+
+#include "checksum.h"
+
+namespace {
+
+const char MAGIC[4] = {'W', 'R', 'L', 'D'};
+
+#pragma pack(push, 1)
+struct FileHeader {
+  char magic[4];
+  uint32_t version;
+  uint32_t generation;
+  uint32_t numStrings;
+  uint32_t numEntities;
+  uint32_t checksum;  // Of everything after the header
+};
+
+// Strings are indices into the string table.
+struct EntityRecord {
+  uint8_t kind;
+  uint8_t order;
+  uint8_t ownerType;
+  uint8_t hasHealth;
+  uint32_t typeID;
+  uint32_t ownerName;
+  uint32_t driver;
+  uint64_t serial;
+  double x, y;
+  uint32_t health;
+  uint32_t corpseTime;
+  uint32_t transformTime;
+  uint32_t quantity;
+  uint16_t numGatherables;
+  uint16_t numInventorySlots;
+  uint16_t numWares;
+  uint16_t numRemainingMaterials;
+};
+
+struct ItemQuantityRecord {
+  uint32_t item;
+  uint32_t quantity;
+};
+
+struct InventorySlotRecord {
+  uint32_t slot;
+  uint32_t item;
+  uint32_t quantity;
+  uint32_t health;
+  uint8_t isSoulbound;
+};
+
+struct WareRecord {
+  uint32_t slot;
+  uint32_t wareItem;
+  uint32_t wareQuantity;
+  uint32_t priceItem;
+  uint32_t priceQuantity;
+};
+#pragma pack(pop)
+
+template <typename T>
+void append(std::string &buffer, const T &value) {
+  buffer.append(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+// Assigns each distinct string an index, in order of first use.
+class StringTable {
+ public:
+  uint32_t indexOf(const std::string &s) {
+    auto it = _indices.find(s);
+    if (it != _indices.end()) return it->second;
+    auto index = static_cast<uint32_t>(_strings.size());
+    _indices[s] = index;
+    _strings.push_back(&s);
+    return index;
+  }
+
+  uint32_t size() const { return static_cast<uint32_t>(_strings.size()); }
+
+  void appendTo(std::string &buffer) const {
+    for (const auto *s : _strings) {
+      append(buffer, static_cast<uint32_t>(s->size()));
+      buffer.append(*s);
+    }
+  }
+
+ private:
+  std::unordered_map<std::string, uint32_t> _indices;
+  std::vector<const std::string *> _strings;  // Owned by the entities
+};
+
+// Copies values out of a buffer, failing rather than reading past its end.
+class Cursor {
+ public:
+  Cursor(const std::string &buffer)
+      : _pos(buffer.data()), _end(buffer.data() + buffer.size()) {}
+
+  template <typename T>
+  bool read(T &value) {
+    if (static_cast<size_t>(_end - _pos) < sizeof(T)) return false;
+    memcpy(&value, _pos, sizeof(T));
+    _pos += sizeof(T);
+    return true;
+  }
+
+  bool read(std::string &s, uint32_t length) {
+    if (static_cast<size_t>(_end - _pos) < length) return false;
+    s.assign(_pos, length);
+    _pos += length;
+    return true;
+  }
+
+ private:
+  const char *_pos, *_end;
+};
+
+}  // namespace
+
+std::string BinaryWorldFile::encode() const {
+  auto strings = StringTable{};
+  auto records = std::string{};
+
+  for (const auto &entity : _entities) {
+    auto record = EntityRecord{};
+    record.kind = entity.kind;
+    record.order = entity.order;
+    record.ownerType = static_cast<uint8_t>(entity.owner.type);
+    record.hasHealth = entity.hasHealth;
+    record.typeID = strings.indexOf(entity.typeID);
+    record.ownerName = strings.indexOf(entity.owner.name);
+    record.driver = strings.indexOf(entity.driver);
+    record.serial = entity.serial.raw();
+    record.x = entity.location.x;
+    record.y = entity.location.y;
+    record.health = entity.health;
+    record.corpseTime = entity.corpseTime;
+    record.transformTime = entity.transformTime;
+    record.quantity = static_cast<uint32_t>(entity.quantity);
+    record.numGatherables = static_cast<uint16_t>(entity.gatherables.size());
+    record.numInventorySlots = static_cast<uint16_t>(entity.inventory.size());
+    record.numWares = static_cast<uint16_t>(entity.wares.size());
+    record.numRemainingMaterials =
+        static_cast<uint16_t>(entity.remainingMaterials.size());
+    append(records, record);
+
+    for (const auto &gatherable : entity.gatherables)
+      append(records,
+             ItemQuantityRecord{strings.indexOf(gatherable.itemID),
+                                static_cast<uint32_t>(gatherable.quantity)});
+
+    for (const auto &slot : entity.inventory)
+      append(records,
+             InventorySlotRecord{static_cast<uint32_t>(slot.slot),
+                                 strings.indexOf(slot.itemID),
+                                 static_cast<uint32_t>(slot.quantity),
+                                 slot.health, slot.isSoulbound});
+
+    for (const auto &ware : entity.wares)
+      append(records,
+             WareRecord{static_cast<uint32_t>(ware.slot),
+                        strings.indexOf(ware.wareItemID),
+                        static_cast<uint32_t>(ware.wareQuantity),
+                        strings.indexOf(ware.priceItemID),
+                        static_cast<uint32_t>(ware.priceQuantity)});
+
+    for (const auto &material : entity.remainingMaterials)
+      append(records,
+             ItemQuantityRecord{strings.indexOf(material.itemID),
+                                static_cast<uint32_t>(material.quantity)});
+  }
+
+  auto body = std::string{};
+  strings.appendTo(body);
+  body.append(records);
+
+  auto header = FileHeader{};
+  memcpy(header.magic, MAGIC, sizeof(MAGIC));
+  header.version = VERSION;
+  header.generation = _generation;
+  header.numStrings = strings.size();
+  header.numEntities = static_cast<uint32_t>(_entities.size());
+  header.checksum = checksum(body.data(), body.size());
+
+  auto contents = std::string{};
+  append(contents, header);
+  contents.append(body);
+  return contents;
+}
+
+bool BinaryWorldFile::publish() const {
+  const auto contents = encode();
+  auto file = std::ofstream{_filename, std::ios_base::binary};
+  file.write(contents.data(), contents.size());
+  file.close();
+  return !file.fail();
+}
+
+bool BinaryWorldFile::load() {
+  auto file = std::ifstream{_filename, std::ios_base::binary};
+  if (!file) return false;
+  file.seekg(0, std::ios_base::end);
+  auto contents = std::string(static_cast<size_t>(file.tellg()), '\0');
+  file.seekg(0);
+  if (!file.read(&contents[0], contents.size())) return false;
+
+  auto cursor = Cursor{contents};
+  auto header = FileHeader{};
+  if (!cursor.read(header)) return false;
+  if (memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0) return false;
+  if (header.version != VERSION) return false;
+  if (checksum(contents.data() + sizeof(header),
+               contents.size() - sizeof(header)) != header.checksum)
+    return false;
+  _generation = header.generation;
+
+  auto strings = std::vector<std::string>(header.numStrings);
+  for (auto &s : strings) {
+    auto length = uint32_t{};
+    if (!cursor.read(length) || !cursor.read(s, length)) return false;
+  }
+  auto isValid = [&](uint32_t index) { return index < strings.size(); };
+
+  _entities.clear();
+  _entities.reserve(header.numEntities);
+  for (auto i = 0u; i != header.numEntities; ++i) {
+    auto record = EntityRecord{};
+    if (!cursor.read(record)) return false;
+    if (!isValid(record.typeID) || !isValid(record.ownerName) ||
+        !isValid(record.driver))
+      return false;
+
+    auto entity = SavedEntity{};
+    entity.kind = static_cast<SavedEntity::Kind>(record.kind);
+    entity.order = static_cast<SavedEntity::Order>(record.order);
+    entity.owner.type =
+        static_cast<Permissions::Owner::Type>(record.ownerType);
+    entity.owner.name = strings[record.ownerName];
+    entity.hasHealth = record.hasHealth != 0;
+    entity.typeID = strings[record.typeID];
+    entity.driver = strings[record.driver];
+    entity.serial = Serial::FromRaw(static_cast<size_t>(record.serial));
+    entity.location = {record.x, record.y};
+    entity.health = record.health;
+    entity.corpseTime = record.corpseTime;
+    entity.transformTime = record.transformTime;
+    entity.quantity = record.quantity;
+
+    entity.gatherables.resize(record.numGatherables);
+    for (auto &gatherable : entity.gatherables) {
+      auto tail = ItemQuantityRecord{};
+      if (!cursor.read(tail) || !isValid(tail.item)) return false;
+      gatherable.itemID = strings[tail.item];
+      gatherable.quantity = tail.quantity;
+    }
+
+    entity.inventory.resize(record.numInventorySlots);
+    for (auto &slot : entity.inventory) {
+      auto tail = InventorySlotRecord{};
+      if (!cursor.read(tail) || !isValid(tail.item)) return false;
+      slot.slot = tail.slot;
+      slot.itemID = strings[tail.item];
+      slot.quantity = tail.quantity;
+      slot.health = tail.health;
+      slot.isSoulbound = tail.isSoulbound != 0;
+    }
+
+    entity.wares.resize(record.numWares);
+    for (auto &ware : entity.wares) {
+      auto tail = WareRecord{};
+      if (!cursor.read(tail) || !isValid(tail.wareItem) ||
+          !isValid(tail.priceItem))
+        return false;
+      ware.slot = tail.slot;
+      ware.wareItemID = strings[tail.wareItem];
+      ware.wareQuantity = tail.wareQuantity;
+      ware.priceItemID = strings[tail.priceItem];
+      ware.priceQuantity = tail.priceQuantity;
+    }
+
+    entity.remainingMaterials.resize(record.numRemainingMaterials);
+    for (auto &material : entity.remainingMaterials) {
+      auto tail = ItemQuantityRecord{};
+      if (!cursor.read(tail) || !isValid(tail.item)) return false;
+      material.itemID = strings[tail.item];
+      material.quantity = tail.quantity;
+    }
+
+    _entities.push_back(std::move(entity));
+  }
+
+  return true;
+}
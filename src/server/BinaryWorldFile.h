@@ -0,0 +1,39 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "SavedEntity.h"
+
+// The world's persistent entities in a versioned binary format.  Strings are
+// stored once, in a table at the start of the file; each entity is a
+// fixed-layout record followed by variable-length tails for its gatherable
+// contents, container, wares and construction materials.  The whole file is
+// read in one go, and loading it is little more than copying the records out.
+// A checksum in the header guards against damage.
+//
+// Numbers are stored in the host's byte order, so files are not portable
+// between architectures.  XML remains the interchange format; see the
+// "import-world-xml" and "export-world-xml" server arguments.
+class BinaryWorldFile {
+ public:
+  static const unsigned VERSION = 2;
+
+  BinaryWorldFile(const std::string &filename) : _filename(filename) {}
+
+  const std::string &filename() const { return _filename; }
+  void filename(const std::string &f) { _filename = f; }
+  unsigned generation() const { return _generation; }
+  void generation(unsigned g) { _generation = g; }
+  const std::vector<SavedEntity> &entities() const { return _entities; }
+  void add(SavedEntity &&entity) { _entities.push_back(std::move(entity)); }
+
+  std::string encode() const;  // The file's contents
+  bool publish() const;        // Write the file, replacing any existing one.
+  bool load();  // False if the file is missing, damaged or of another version
+
+ private:
+  std::string _filename;
+  unsigned _generation{0};
+  std::vector<SavedEntity> _entities;
+};
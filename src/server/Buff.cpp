@@ -16,17 +16,54 @@ Buff::Buff(const BuffType &type, Entity &owner, Entity &caster)
     : _type(&type),
       _owner(&owner),
       _caster(&caster),
-      _timeRemaining(type.duration()) {}
+      _timeRemaining(type.duration()) {
+  registerWithCaster();
+}
 
 Buff::Buff(const BuffType &type, Entity &owner, ms_t timeRemaining)
     : _type(&type), _owner(&owner), _timeRemaining(timeRemaining) {}
 
+Buff::Buff(const Buff &rhs)
+    : _type(rhs._type),
+      _owner(rhs._owner),
+      _caster(rhs._caster),
+      _timeSinceLastProc(rhs._timeSinceLastProc),
+      _timeRemaining(rhs._timeRemaining),
+      _expired(rhs._expired) {
+  registerWithCaster();
+}
+
+Buff &Buff::operator=(const Buff &rhs) {
+  if (this == &rhs) return *this;
+  deregisterFromCaster();
+  _type = rhs._type;
+  _owner = rhs._owner;
+  _caster = rhs._caster;
+  _timeSinceLastProc = rhs._timeSinceLastProc;
+  _timeRemaining = rhs._timeRemaining;
+  _expired = rhs._expired;
+  registerWithCaster();
+  return *this;
+}
+
+Buff::~Buff() { deregisterFromCaster(); }
+
+void Buff::registerWithCaster() const {
+  if (_owner && _caster) References::add(*_owner, *_caster);
+}
+
+void Buff::deregisterFromCaster() const {
+  if (_owner && _caster) References::remove(*_owner, *_caster);
+}
+
 bool Buff::doesntStackWith(const BuffType &otherType) const {
   return _type->doesntStackWith(otherType);
 }
 
 void Buff::clearCasterIfEqualTo(const Entity &casterToRemove) const {
-  if (_caster == &casterToRemove) _caster = nullptr;
+  if (_caster != &casterToRemove) return;
+  deregisterFromCaster();
+  _caster = nullptr;
 }
 
 void Buff::update(ms_t timeElapsed) {
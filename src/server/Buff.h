@@ -84,6 +84,10 @@ class Buff {
 
   Buff(const BuffType &type, Entity &owner, Entity &caster);
   Buff(const BuffType &type, Entity &owner, ms_t timeRemaining);
+  // These keep the owner registered as one of the caster's References.
+  Buff(const Buff &rhs);
+  Buff &operator=(const Buff &rhs);
+  ~Buff();
 
   const ID &type() const { return _type->id(); }
   bool hasExpired() const { return _expired; }
@@ -97,6 +101,7 @@ class Buff {
   bool doesntStackWith(const BuffType &otherType) const;
 
   bool hasSameType(const Buff &rhs) const { return _type == rhs._type; }
+  const Entity *caster() const { return _caster; }
 
   void applyStatsTo(Stats &stats) const { stats &= _type->stats(); }
 
@@ -116,6 +121,9 @@ class Buff {
   // When loaded from XML (User logged off with buff), this is null.
   mutable Entity *_caster = nullptr;
 
+  void registerWithCaster() const;
+  void deregisterFromCaster() const;
+
   ms_t _timeSinceLastProc{0};
   ms_t _timeRemaining{0};
 
@@ -1,7 +1,7 @@
 #include "City.h"
 
 #include "../XmlReader.h"
-#include "../XmlWriter.h"
+#include "../XmlStreamWriter.h"
 #include "Server.h"
 
 City::Members Cities::dummyMembersList{};
@@ -114,26 +114,27 @@ City::Name Cities::getPlayerCity(const std::string &username) const {
   return it->second;
 }
 
-void Cities::writeToXMLFile(const std::string &filename) const {
-  XmlWriter xw(filename);
+void Cities::writeToXML(XmlStreamWriter &xw) const {
   for (const auto &pair : _container) {
     const City &city = pair.second;
 
-    auto e = xw.addChild("city");
-    xw.setAttr(e, "name", pair.first);
+    xw.openElement("city");
+    xw.setAttr("name", pair.first);
+    xw.setAttr("king", city.king());
 
-    auto locE = xw.addChild("location", e);
-    xw.setAttr(locE, "x", city.location().x);
-    xw.setAttr(locE, "y", city.location().y);
-
-    xw.setAttr(e, "king", city.king());
+    xw.openElement("location");
+    xw.setAttr("x", city.location().x);
+    xw.setAttr("y", city.location().y);
+    xw.closeElement();
 
     for (const std::string &member : city.members()) {
-      auto memberE = xw.addChild("member", e);
-      xw.setAttr(memberE, "username", member);
+      xw.openElement("member");
+      xw.setAttr("username", member);
+      xw.closeElement();
     }
+
+    xw.closeElement();
   }
-  xw.publish();
 }
 
 void Cities::readFromXMLFile(const std::string &filename) {
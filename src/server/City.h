@@ -8,6 +8,7 @@
 #include "../Point.h"
 
 class User;
+class XmlStreamWriter;
 
 class Kings {
  public:
@@ -68,7 +69,7 @@ class Cities {
 
   void sendInfoAboutCitiesTo(const User &recipient) const;
 
-  void writeToXMLFile(const std::string &filename) const;
+  void writeToXML(XmlStreamWriter &xw) const;
   void readFromXMLFile(const std::string &filename);
 
  private:
@@ -3,10 +3,12 @@
 #include <windows.h>
 
 #include <algorithm>
+#include <chrono>
 #include <set>
 
 #include "../Args.h"
 #include "../XmlReader.h"
+#include "../parallel.h"
 #include "ProgressLock.h"
 #include "Server.h"
 #include "VehicleType.h"
@@ -30,6 +32,12 @@ DataLoader DataLoader::FromString(Server &server, const XML &data) {
 
 void DataLoader::load(bool keepOldData) {
   _server._debug("Loading data");
+  auto loading = _server._startupProfile.phase(
+      "Loading data from "s + (_path.empty() ? "string"s : _path));
+
+  // Entries may be replaced or removed, so searches go to the registries
+  // themselves until the indexes are rebuilt.
+  _server.clearTypeIndexes();
 
   if (!keepOldData) {
     _server._entities.clear();
@@ -47,34 +55,49 @@ void DataLoader::load(bool keepOldData) {
   if (usingPath) {
     _files = findDataFiles();
 
+    // The map is parsed alongside everything else.
+    auto filenames = std::vector<std::string>{_files.begin(), _files.end()};
+    filenames.push_back(_path + "/map.xml");
+
+    auto documents = Documents{};
+    {
+      auto parsing = _server._startupProfile.phase("Parsing files");
+      documents = parseFiles(filenames);
+    }
+    auto map = std::move(documents.back());
+    documents.pop_back();
+
     if (isDebug()) {
-      for (const auto &filename : _files) {
-        auto xr = XmlReader::FromFile(filename);
-        if (!xr) {
-          _server._debug("Failed to load XML file "s + filename,
-                         Color::CHAT_ERROR);
-        }
+      for (auto i = size_t{0}; i != documents.size(); ++i) {
+        if (*documents[i]) continue;
+        _server._debug("Failed to load XML file "s + filenames[i],
+                       Color::CHAT_ERROR);
       }
     }
 
-    loadFromAllFiles(&DataLoader::loadTerrain);
-    loadFromAllFiles(&DataLoader::loadTerrainLists);
-
-    auto reader = XmlReader::FromFile(_path + "/map.xml");
-    loadMap(reader);
-
-    loadFromAllFiles(&DataLoader::loadCompositeStats);
-    loadFromAllFiles(&DataLoader::loadLootTables);
-    loadFromAllFiles(&DataLoader::loadObjectTypes);
-    loadFromAllFiles(&DataLoader::loadNPCTemplates);
-    loadFromAllFiles(&DataLoader::loadNPCTypes);
-    loadFromAllFiles(&DataLoader::loadItems);
-    loadFromAllFiles(&DataLoader::loadQuests);
-    loadFromAllFiles(&DataLoader::loadRecipes);
-    loadFromAllFiles(&DataLoader::loadSpells);
-    loadFromAllFiles(&DataLoader::loadBuffs);
-    loadFromAllFiles(&DataLoader::loadClasses);
-    loadFromAllFiles(&DataLoader::loadSpawners);
+    // From here on, everything happens in file order on this thread, so that
+    // references between files are resolved the same way every time.
+    loadFromAllFiles(documents, &DataLoader::loadTerrain, "terrain");
+    loadFromAllFiles(documents, &DataLoader::loadTerrainLists, "terrain lists");
+
+    {
+      auto loadingMap = _server._startupProfile.phase("Loading map");
+      loadMap(*map);
+    }
+
+    loadFromAllFiles(documents, &DataLoader::loadCompositeStats,
+                     "composite stats");
+    loadFromAllFiles(documents, &DataLoader::loadLootTables, "loot tables");
+    loadFromAllFiles(documents, &DataLoader::loadObjectTypes, "object types");
+    loadFromAllFiles(documents, &DataLoader::loadNPCTemplates, "NPC templates");
+    loadFromAllFiles(documents, &DataLoader::loadNPCTypes, "NPC types");
+    loadFromAllFiles(documents, &DataLoader::loadItems, "items");
+    loadFromAllFiles(documents, &DataLoader::loadQuests, "quests");
+    loadFromAllFiles(documents, &DataLoader::loadRecipes, "recipes");
+    loadFromAllFiles(documents, &DataLoader::loadSpells, "spells");
+    loadFromAllFiles(documents, &DataLoader::loadBuffs, "buffs");
+    loadFromAllFiles(documents, &DataLoader::loadClasses, "classes");
+    loadFromAllFiles(documents, &DataLoader::loadSpawners, "spawners");
 
   } else {
     auto data = XmlReader::FromString(_data);
@@ -102,12 +125,31 @@ void DataLoader::load(bool keepOldData) {
   _server._dataLoaded = true;
 }
 
-void DataLoader::loadFromAllFiles(LoadFunction load) {
-  for (const auto &file : _files) {
-    auto xr = XmlReader::FromFile(file);
-    if (!xr) continue;
-    (this->*load)(xr);
-  }
+DataLoader::Documents DataLoader::parseFiles(
+    const std::vector<std::string> &filenames) const {
+  auto documents = Documents(filenames.size());
+  auto parse = [&](size_t i) {
+    const auto start = std::chrono::steady_clock::now();
+    documents[i] = std::make_unique<XmlReader>();
+    documents[i]->newFile(filenames[i]);
+    const auto time = std::chrono::steady_clock::now() - start;
+    _server._startupProfile.addPart(
+        filenames[i], std::chrono::duration<double, std::milli>{time}.count());
+  };
+
+  if (cmdLineArgs.contains("load-data-serially"))
+    for (auto i = size_t{0}; i != filenames.size(); ++i) parse(i);
+  else
+    parallelFor(filenames.size(), parse, "Data parser");
+
+  return documents;
+}
+
+void DataLoader::loadFromAllFiles(const Documents &documents,
+                                  LoadFunction load, const char *what) {
+  auto phase = _server._startupProfile.phase("Loading "s + what);
+  for (const auto &xr : documents)
+    if (*xr) (this->*load)(*xr);
 }
 
 DataLoader::FilesList DataLoader::findDataFiles() const {
@@ -131,6 +173,33 @@ DataLoader::FilesList DataLoader::findDataFiles() const {
   return list;
 }
 
+void DataLoader::reload(const Documents &documents) {
+  _server.clearTypeIndexes();
+
+  loadFromAllFiles(documents, &DataLoader::loadCompositeStats,
+                   "composite stats");
+  loadFromAllFiles(documents, &DataLoader::loadLootTables, "loot tables");
+  loadFromAllFiles(documents, &DataLoader::loadObjectTypes, "object types");
+  loadFromAllFiles(documents, &DataLoader::loadNPCTemplates, "NPC templates");
+  loadFromAllFiles(documents, &DataLoader::loadNPCTypes, "NPC types");
+  loadFromAllFiles(documents, &DataLoader::loadItems, "items");
+  loadFromAllFiles(documents, &DataLoader::loadQuests, "quests");
+  loadFromAllFiles(documents, &DataLoader::loadRecipes, "recipes");
+  loadFromAllFiles(documents, &DataLoader::loadSpells, "spells");
+  loadFromAllFiles(documents, &DataLoader::loadBuffs, "buffs");
+
+  _server.reinitialiseData(_redefinedTypes);
+}
+
+// Gives an existing type a new definition in place, so that everything
+// referring to it stays valid, without losing count of its objects.
+template <typename T>
+static void redefine(T &type, const T &definition) {
+  const auto numInWorld = type.numInWorld();
+  type = definition;
+  type.numInWorld(numInWorld);
+}
+
 void DataLoader::loadTerrain(XmlReader &xr) {
   for (auto elem : xr.getChildren("terrain")) {
     char index;
@@ -356,7 +425,8 @@ void DataLoader::loadObjectTypes(XmlReader &xr) {
          it != _server._objectTypes.end(); ++it) {
       if ((*it)->id() == ot->id()) {
         ObjectType &inPlace = *const_cast<ObjectType *>(*it);
-        inPlace = *ot;
+        redefine(inPlace, *ot);
+        _redefinedTypes.insert(&inPlace);
         delete ot;
         alreadyExists = true;
         break;
@@ -373,6 +443,8 @@ void DataLoader::loadQuests(XmlReader &xr) {
     // It may already exist, due to being a prerequisite.
     auto &q = _server._quests[id];
     q.id = id;
+    q.objectives.clear();
+    q.rewards.clear();
 
     auto startsAt = ""s;
     if (!xr.findAttr(elem, "startsAt", startsAt)) continue;
@@ -500,6 +572,9 @@ void DataLoader::loadNPCTypes(XmlReader &xr) {
     if (!nt) {
       nt = new NPCType(id);
       _server._objectTypes.insert(nt);
+    } else {
+      redefine(*nt, NPCType{id});
+      _redefinedTypes.insert(nt);
     }
 
     auto templateID = ""s;
@@ -823,7 +898,11 @@ void DataLoader::loadRecipes(XmlReader &xr) {
     }
     if (!requiresUnlock) recipe.knownByDefault();
 
-    _server._recipes.insert(recipe);
+    auto ret = _server._recipes.insert(recipe);
+    if (!ret.second) {
+      SRecipe &recipeInPlace = const_cast<SRecipe &>(*ret.first);
+      recipeInPlace = recipe;
+    }
   }
 }
 
@@ -831,8 +910,12 @@ void DataLoader::loadSpells(XmlReader &xr) {
   for (auto elem : xr.getChildren("spell")) {
     std::string id;
     if (!xr.findAttr(elem, "id", id)) continue;  // ID is mandatory.
-    auto newSpell = new Spell;
-    _server._spells[id] = newSpell;
+    // An existing spell is redefined in place, as it may be referred to.
+    auto &newSpell = _server._spells[id];
+    if (newSpell)
+      *newSpell = Spell{};
+    else
+      newSpell = new Spell;
     newSpell->id(id);
 
     auto name = Spell::Name{};
@@ -1098,4 +1181,5 @@ void DataLoader::loadMap(XmlReader &xr) {
   }
 
   _server._map.loadFromXML(xr);
+  _server._terrainTileIndexes.clear();
 }
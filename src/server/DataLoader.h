@@ -1,8 +1,11 @@
 #pragma once
 
+#include <memory>
 #include <set>
 #include <string>
+#include <vector>
 
+class EntityType;
 class Server;
 class XmlReader;
 
@@ -15,6 +18,17 @@ class DataLoader {
 
   void load(bool keepOldData = false);
 
+  // Every data file is parsed once, up front, and each pass walks the result.
+  // Files are parsed in parallel, into documents in the same order as the
+  // filenames; a document is empty if its file couldn't be parsed.
+  using Documents = std::vector<std::unique_ptr<XmlReader>>;
+  Documents parseFiles(const std::vector<std::string> &filenames) const;
+
+  // Loads the types defined in these documents into a running server.
+  // Existing types are redefined in place.  Terrain, the map, classes and
+  // spawners are left as they are.
+  void reload(const Documents &documents);
+
   void loadTerrain(XmlReader &reader);
   void loadTerrainLists(XmlReader &reader);
   void loadCompositeStats(XmlReader &reader);
@@ -41,9 +55,12 @@ class DataLoader {
   XML _data;
 
   using LoadFunction = void (DataLoader::*)(XmlReader &);
-  void loadFromAllFiles(LoadFunction load);
+  void loadFromAllFiles(const Documents &documents, LoadFunction load,
+                        const char *what);  // Named for the startup profile
 
   using FilesList = std::set<std::string>;
   FilesList findDataFiles() const;
   FilesList _files;
+
+  std::set<const EntityType *> _redefinedTypes;  // By reload()
 };
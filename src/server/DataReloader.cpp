@@ -0,0 +1,107 @@
+#include "DataReloader.h"
+
+#include <SDL.h>
+#include <sys/stat.h>
+
+#include "../XmlReader.h"
+#include "../threadNaming.h"
+#include "../util.h"
+#include "Server.h"
+
+extern Args cmdLineArgs;
+
+DataReloader::DataReloader(Server &server) : _server(server) {}
+
+DataReloader::~DataReloader() {
+#ifndef SINGLE_THREAD
+  if (_worker.joinable()) _worker.join();
+#endif
+}
+
+void DataReloader::noteFilesLoaded(const std::string &directory) {
+  _directory = directory;
+  _loadedFiles = findStatuses();
+}
+
+void DataReloader::start() {
+  if (_directory.empty() || _isReloading) return;
+  _isReloading = true;
+  _filesAreParsed = false;
+
+#ifdef SINGLE_THREAD
+  parseChangedFiles();
+#else
+  _worker = std::thread{[this]() {
+    setThreadName("Reloading data");
+    parseChangedFiles();
+  }};
+#endif
+}
+
+void DataReloader::update(ms_t time) {
+  if (cmdLineArgs.contains("watch-data") &&
+      time - _timeLastWatched >= WATCH_FREQUENCY) {
+    _timeLastWatched = time;
+    start();
+  }
+
+  if (!_isReloading || !_filesAreParsed) return;
+#ifndef SINGLE_THREAD
+  _worker.join();
+#endif
+  _isReloading = false;
+  if (_changedFilenames.empty()) return;
+
+  // A file that failed to parse is left as it was, and tried again next time.
+  auto numReloaded = 0;
+  for (auto i = size_t{0}; i != _changedFilenames.size(); ++i) {
+    const auto &filename = _changedFilenames[i];
+    if (*_documents[i]) {
+      _loadedFiles[filename] = _changedFiles[filename];
+      ++numReloaded;
+    } else
+      _server._debug("Failed to reload XML file "s + filename,
+                     Color::CHAT_ERROR);
+  }
+
+  const auto timeBeforeApplying = SDL_GetTicks();
+  DataLoader::FromPath(_server, _directory).reload(_documents);
+  const auto applyTime = SDL_GetTicks() - timeBeforeApplying;
+
+  _server._debug << Color::CHAT_SUCCESS << "Reloaded " << numReloaded
+                 << " data files: parsed in " << _parseTime
+                 << " ms, applied in " << applyTime << " ms" << Log::endl;
+
+  _changedFiles.clear();
+  _changedFilenames.clear();
+  _documents.clear();
+}
+
+DataReloader::FileStatuses DataReloader::findStatuses() const {
+  auto statuses = FileStatuses{};
+  for (const auto &filename : getXMLFiles(_directory, "map.xml")) {
+    struct stat info;
+    if (stat(filename.c_str(), &info) != 0) continue;
+    statuses[filename] = {info.st_size, info.st_mtime};
+  }
+  return statuses;
+}
+
+void DataReloader::parseChangedFiles() {
+  const auto timeBeforeParsing = SDL_GetTicks();
+
+  // Files are kept in the order they were first loaded in, so that references
+  // between them are resolved the same way.
+  for (const auto &pair : findStatuses()) {
+    auto it = _loadedFiles.find(pair.first);
+    if (it != _loadedFiles.end() && it->second == pair.second) continue;
+    _changedFiles.insert(pair);
+    _changedFilenames.push_back(pair.first);
+  }
+
+  _documents =
+      DataLoader::FromPath(_server, _directory).parseFiles(_changedFilenames);
+
+  _parseTime = SDL_GetTicks() - timeBeforeParsing;
+  _filesAreParsed = true;
+}
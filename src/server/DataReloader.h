@@ -0,0 +1,64 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "../types.h"
+#include "DataLoader.h"
+
+#ifndef SINGLE_THREAD
+#include <thread>
+#endif
+
+class Server;
+
+// Reloads data files that have changed since they were loaded, without
+// restarting the server.  Changed files are found and parsed on a background
+// thread; the game thread then applies them between ticks, redefining types in
+// place so that existing objects, items and users keep referring to them.
+// Terrain, the map, classes and spawners aren't reloaded.
+//
+// A reload is started by a debug command, or every so often if the server is
+// run with the "watch-data" argument.
+class DataReloader {
+ public:
+  DataReloader(Server &server);
+  ~DataReloader();  // Waits for any parsing in progress.
+
+  void noteFilesLoaded(const std::string &directory);
+  void start();  // Does nothing if a reload is already in progress
+  void update(ms_t time);  // Applies parsed files, on the game thread
+
+ private:
+  struct FileStatus {
+    int64_t size, timeModified;
+    bool operator==(const FileStatus &rhs) const {
+      return size == rhs.size && timeModified == rhs.timeModified;
+    }
+  };
+  using FileStatuses = std::map<std::string, FileStatus>;  // By filename
+  FileStatuses findStatuses() const;
+  void parseChangedFiles();
+
+  Server &_server;
+  std::string _directory;  // Empty if data wasn't loaded from files
+  FileStatuses _loadedFiles;
+
+  static const ms_t WATCH_FREQUENCY = 10000;
+  ms_t _timeLastWatched{0};
+
+  bool _isReloading{false};
+  std::atomic<bool> _filesAreParsed{false};
+  // Written by the parsing, and read once it's finished
+  FileStatuses _changedFiles;
+  std::vector<std::string> _changedFilenames;  // In loading order
+  DataLoader::Documents _documents;
+  ms_t _parseTime{0};
+
+#ifndef SINGLE_THREAD
+  std::thread _worker;
+#endif
+};
@@ -12,6 +12,8 @@ DroppedItem::Type::Type() : EntityType("droppedItem") {
 DroppedItem::DroppedItem(const ServerItem &itemType, size_t quantity,
                          const MapPoint &location)
     : Entity(&TYPE, location), _quantity(quantity), _itemType(itemType) {
+  classTag('i');
+
   // Once-off init
   if (!TYPE.collides()) TYPE.collisionRect({-8, -8, 16, 16});
 }
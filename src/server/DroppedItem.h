@@ -16,7 +16,7 @@ class DroppedItem : public Entity {
               const MapPoint &location);
   ~DroppedItem() {}
 
-  char classTag() const override { return 'i'; }
+  static bool hasClassTag(char tag) { return tag == 'i'; }
   void sendInfoToClient(const User &targetUser,
                         bool isNew = false) const override;
   ms_t timeToRemainAsCorpse() const override { return 0; }
@@ -24,7 +24,7 @@ class DroppedItem : public Entity {
   bool areOverlapsAllowedWith(const Entity &rhs) const override;
   void getPickedUpBy(User &user);
 
-  void writeToXML(XmlWriter &xw) const override;
+  bool getSavedState(SavedEntity &saved) const override;
 
   static Type TYPE;
 
@@ -11,11 +11,21 @@ Entity *Entities::find(Serial serial) {
   return *it;
 }
 
-const Vehicle *Entities::findVehicleDrivenBy(const User &driver) {
-  for (const auto pEntity : _container) {
-    auto vehicle = dynamic_cast<const Vehicle *>(pEntity);
-    if (!vehicle) continue;
-    if (vehicle->driver() == driver.name()) return vehicle;
-  }
-  return nullptr;
+const Vehicle *Entities::findVehicleDrivenBy(const User &driver) const {
+  auto it = _vehiclesByDriver.find(driver.name());
+  if (it == _vehiclesByDriver.end()) return nullptr;
+  return it->second;
+}
+
+void Entities::registerDriver(const Vehicle &vehicle) {
+  if (vehicle.driver().empty()) return;
+  _vehiclesByDriver[vehicle.driver()] = &vehicle;
+}
+
+void Entities::deregisterDriver(const Vehicle &vehicle) {
+  if (vehicle.driver().empty()) return;
+  auto it = _vehiclesByDriver.find(vehicle.driver());
+  if (it == _vehiclesByDriver.end()) return;
+  if (it->second != &vehicle) return;
+  _vehiclesByDriver.erase(it);
 }
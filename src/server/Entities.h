@@ -12,7 +12,10 @@ class Entities {
   typedef Container::const_iterator iterator;
 
  public:
-  void clear() { _container.clear(); }
+  void clear() {
+    _container.clear();
+    _vehiclesByDriver.clear();
+  }
   size_t size() const { return _container.size(); }
   bool empty() const { return size() == 0; }
   void insert(Entity *p) { _container.insert(p); }
@@ -24,13 +27,17 @@ class Entities {
   template <typename T>
   T *find(Serial serial) {
     Entity *pEnt = find(serial);
-    return dynamic_cast<T *>(pEnt);
+    return pEnt ? pEnt->as<T>() : nullptr;
   }
 
-  const Vehicle *findVehicleDrivenBy(const User &driver);
+  const Vehicle *findVehicleDrivenBy(const User &driver) const;
+  // Maintained by Vehicle whenever its driver changes.
+  void registerDriver(const Vehicle &vehicle);
+  void deregisterDriver(const Vehicle &vehicle);
 
  private:
   Container _container;
+  std::map<std::string, const Vehicle *> _vehiclesByDriver;
 };
 
 #endif
@@ -22,7 +22,8 @@ Entity::Entity(const EntityType *type, const MapPoint &loc)
 
       permissions(*this),
       gatherable(*this),
-      transformation(*this) {
+      transformation(*this),
+      tagger(*this) {
   initStatsFromType();
 }
 
@@ -31,17 +32,20 @@ Entity::Entity(Serial serial)
       _serial(serial),
       permissions(*this),
       gatherable(*this),
-      transformation(*this) {}
+      transformation(*this),
+      tagger(*this) {}
 
 Entity::Entity(const MapPoint &loc)
     :  // For set/map lookup ONLY
       _location(loc),
       permissions(*this),
       gatherable(*this),
-      transformation(*this) {}
+      transformation(*this),
+      tagger(*this) {}
 
 Entity::~Entity() {
   if (_spawner) _spawner->scheduleSpawn();
+  References::removeAllInvolving(*this);
 }
 
 bool Entity::compareSerial::operator()(const Entity *a, const Entity *b) const {
@@ -82,6 +86,7 @@ void Entity::changeType(const EntityType *newType,
   gatherable.removeAllGatheringUsers();
 
   onSetType(shouldSkipConstruction);
+  markAsChanged();
 
   // Inform nearby users
   for (const User *user : server.findUsersInArea(location()))
@@ -94,10 +99,33 @@ void Entity::changeType(const EntityType *newType,
 }
 
 void Entity::onSetType(bool shouldSkipConstruction) {
+  refreshCapabilities();
+
   gatherable.populateContents();
   transformation.initialise();
 }
 
+void Entity::markAsChanged() {
+  if (_hasUnsavedChanges || _excludedFromPersistentState) return;
+  auto *server = Server::_instance;
+  if (!server) return;
+  _hasUnsavedChanges = true;
+
+  // Users are saved to their own files, and need only the flag.
+  if (classTag() != 'u') server->_entitiesWithUnsavedChanges.insert(serial());
+}
+
+void Entity::refreshCapabilities() {
+  setCapability(HAS_TAGS, _type && _type->hasTags());
+}
+
+void Entity::setCapability(Capability c, bool isSet) {
+  if (isSet)
+    _capabilities |= c;
+  else
+    _capabilities &= ~c;
+}
+
 CombatResult Entity::generateHitAgainst(const Entity &target, CombatType type,
                                         SpellSchool school, px_t range) const {
   auto levelDiff = target.level() - level();
@@ -186,6 +214,7 @@ void Entity::reduceHealth(int damage) {
   if (damage >= static_cast<int>(_health)) {
     startCorpseTimer();
     _health = 0;
+    markAsChanged();
     onHealthChange();
     onDeath();
   } else {
@@ -197,6 +226,7 @@ void Entity::reduceHealth(int damage) {
                       Color::CHAT_ERROR);
       _health = this->_stats.maxHealth;
     }
+    markAsChanged();
     onHealthChange();
   }
   broadcastDamagedMessage(damage);
@@ -206,12 +236,14 @@ void Entity::reduceEnergy(int amount) {
   if (amount == 0) return;
   if (amount > static_cast<int>(_energy)) amount = _energy;
   _energy -= amount;
+  markAsChanged();
   onEnergyChange();
 }
 
 void Entity::healBy(Hitpoints amount) {
   auto newHealth = min(health() + amount, _stats.maxHealth);
   _health = newHealth;
+  markAsChanged();
   onHealthChange();
   broadcastHealedMessage(amount);
 }
@@ -525,6 +557,13 @@ void Entity::onAttackedBy(Entity &attacker, Threat threat) {
   for (auto buff : interruptibleBuffs()) removeBuff(buff);
 }
 
+void Entity::target(Entity *p) {
+  if (p == _target) return;
+  if (_target) References::remove(*this, *_target);
+  _target = p;
+  if (_target) References::add(*this, *_target);
+}
+
 void Entity::startCorpseTimer() { _corpseTime = timeToRemainAsCorpse(); }
 
 void Entity::location(const MapPoint &newLoc, bool firstInsertion) {
@@ -569,6 +608,7 @@ void Entity::location(const MapPoint &newLoc, bool firstInsertion) {
   }
 
   _location = newLoc;
+  markAsChanged();
 
   // Re-insert into location-indexed trees
   if (classTag() == 'u') {
@@ -685,11 +725,15 @@ void Entity::tellRelevantUsersAboutLootSlot(size_t slot) const {
 }
 
 bool Entity::shouldAlwaysBeKnownToUser(const User &user) const {
-  if (permissions.isOwnedByPlayer(user.name())) return true;
+  // There is deliberately no separate "always known" index: the entity's own
+  // owner record answers this directly, and the user's city is only looked
+  // up when a city owns this.  ObjectsByOwner covers the reverse query.
+  const auto &owner = permissions.owner();
+  if (owner.type == Permissions::Owner::PLAYER)
+    return owner.name == user.name();
+  if (owner.type != Permissions::Owner::CITY) return false;
   const Server &server = *Server::_instance;
-  const auto &city = server.cities().getPlayerCity(user.name());
-  if (!city.empty() && permissions.isOwnedByCity(city)) return true;
-  return false;
+  return server.cities().getPlayerCity(user.name()) == owner.name;
 }
 
 const Loot &Entity::loot() const {
@@ -734,6 +778,7 @@ std::vector<BuffType::ID> Entity::buffsThatCancelOnOOE() const {
 
 void Entity::applyBuff(const BuffType &type, Entity &caster) {
   if (isDead()) return;
+  markAsChanged();
 
   // Check whether it doesn't stack with something else
   for (auto &buff : _buffs) {
@@ -826,6 +871,7 @@ void Entity::loadDebuff(const BuffType &type, ms_t timeRemaining) {
 }
 
 void Entity::removeBuff(Buff::ID id) {
+  markAsChanged();
   for (auto it = _buffs.begin(); it != _buffs.end(); ++it)
     if (it->type() == id) {
       const auto changesAllowedTerrain = it->changesAllowedTerrain();
@@ -845,6 +891,7 @@ void Entity::removeBuff(Buff::ID id) {
 }
 
 void Entity::removeDebuff(Buff::ID id) {
+  markAsChanged();
   for (auto it = _debuffs.begin(); it != _debuffs.end(); ++it)
     if (it->type() == id) {
       const auto changesAllowedTerrain = it->changesAllowedTerrain();
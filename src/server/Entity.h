@@ -14,12 +14,13 @@
 #include "Gatherable.h"
 #include "Loot.h"
 #include "Permissions.h"
+#include "References.h"
 #include "ServerItem.h"
 #include "Tagger.h"
 #include "ThreatTable.h"
 
 class Spawner;
-class XmlWriter;
+struct SavedEntity;
 class NPC;
 class User;
 
@@ -34,7 +35,30 @@ class Entity {
 
   const EntityType *type() const { return _type; }
 
-  virtual char classTag() const = 0;
+  // Set once by each concrete class's constructor, so that hot loops can
+  // identify an entity without a virtual call or a dynamic_cast.
+  char classTag() const { return _classTag; }
+
+  // A checked downcast: null if this entity isn't a T.  T must provide
+  // static bool hasClassTag(char).
+  template <typename T>
+  T *as() {
+    return T::hasClassTag(_classTag) ? static_cast<T *>(this) : nullptr;
+  }
+  template <typename T>
+  const T *as() const {
+    return T::hasClassTag(_classTag) ? static_cast<const T *>(this) : nullptr;
+  }
+
+  // Cached properties of the current type, refreshed in onSetType() or when
+  // the type is redefined, for cheap filtering in proximity scans.
+  enum Capability : unsigned char {
+    HAS_TAGS = 1 << 0,  // Can be used as a tool
+    GRANTS_BUFF = 1 << 1,
+    IS_GATE = 1 << 2
+  };
+  bool hasCapability(Capability c) const { return (_capabilities & c) != 0; }
+  virtual void refreshCapabilities();
 
   struct compareSerial {
     bool operator()(const Entity *a, const Entity *b) const;
@@ -58,7 +82,8 @@ class Entity {
   virtual void sendInfoToClient(const User &targetUser,
                                 bool isNew = false) const = 0;
 
-  virtual void writeToXML(XmlWriter &xw) const {}
+  // Describe the entity for saving; false if it isn't saved after all.
+  virtual bool getSavedState(SavedEntity &saved) const { return false; }
 
   void changeType(const EntityType *newType,
                   bool shouldSkipConstruction = false);
@@ -92,7 +117,7 @@ class Entity {
 
   // Combat
   Entity *target() const { return _target; }
-  void target(Entity *p) { _target = p; }
+  void target(Entity *p);
   virtual void updateStats() {}  // Recalculate _stats based on any modifiers
   virtual ms_t timeToRemainAsCorpse() const = 0;
   ms_t corpseTime() const { return _corpseTime; }
@@ -156,8 +181,14 @@ class Entity {
 
   void initStatsFromType();
   void fillHealthAndEnergy();
-  void health(Hitpoints health) { _health = health; }  // TODO: Remove
-  void energy(Energy energy) { _energy = energy; }     // TODO: Remove
+  void health(Hitpoints health) {  // TODO: Remove
+    _health = health;
+    markAsChanged();
+  }
+  void energy(Energy energy) {  // TODO: Remove
+    _energy = energy;
+    markAsChanged();
+  }
   bool isDead() const { return _health == 0; }
 
   void kill() { reduceHealth(health()); }
@@ -188,10 +219,18 @@ class Entity {
   // const;
   virtual void sendAllLootToTaggers() const;
   void excludeFromPersistentState() { _excludedFromPersistentState = true; }
-  void includeInPersistentState() { _excludedFromPersistentState = false; }
+  void includeInPersistentState() {
+    _excludedFromPersistentState = false;
+    markAsChanged();
+  }
   bool excludedFromPersistentState() const {
     return _excludedFromPersistentState;
   }
+  // Queue this entity to be written by the next incremental world save.  Call
+  // after any change to state that getSavedState() records.
+  void markAsChanged();
+  void markAsSaved() { _hasUnsavedChanges = false; }
+  bool hasUnsavedChanges() const { return _hasUnsavedChanges; }
   virtual void alertReactivelyTargetingUser(const User &targetingUser) const;
 
   void tellRelevantUsersAboutLootSlot(size_t slot) const;
@@ -225,6 +264,7 @@ class Entity {
 
   virtual bool areOverlapsAllowedWith(const Entity &rhs) const;
 
+  References references;  // Declared before any members that hold links.
   Permissions permissions;
   Gatherable gatherable;
   Transformation transformation;
@@ -237,11 +277,16 @@ class Entity {
     _lastLocUpdate = SDL_GetTicks();
   }  // To be called when movement starts
   static const px_t MELEE_RANGE;
+  void classTag(char tag) { _classTag = tag; }
+  void setCapability(Capability c, bool isSet);
 
  private:
   const EntityType *_type{nullptr};
+  char _classTag{'\0'};
+  unsigned char _capabilities{0};
 
   bool _excludedFromPersistentState{false};
+  bool _hasUnsavedChanges{false};
 
   Spawner *_spawner{nullptr};  // The Spawner that created this entity, if any.
 
@@ -279,11 +324,10 @@ class Dummy : public Entity {
 
  private:
   friend class Entity;
-  Dummy(Serial serial) : Entity(serial) {}
-  Dummy(const MapPoint &loc) : Entity(loc) {}
+  Dummy(Serial serial) : Entity(serial) { classTag('d'); }
+  Dummy(const MapPoint &loc) : Entity(loc) { classTag('d'); }
 
   // Necessary overrides to make this a concrete class
-  char classTag() const override { return 'd'; }
   void sendInfoToClient(const User &targetUser,
                         bool isNew = false) const override {}
   ms_t timeToRemainAsCorpse() const override { return 0; }
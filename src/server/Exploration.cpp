@@ -1,7 +1,7 @@
 #include "Exploration.h"
 
 #include "../XmlReader.h"
-#include "../XmlWriter.h"
+#include "../XmlStreamWriter.h"
 #include "Server.h"
 
 Exploration::Exploration(size_t mapWidth, size_t mapHeight) {
@@ -10,17 +10,19 @@ Exploration::Exploration(size_t mapWidth, size_t mapHeight) {
   _map = {chunksX, std::vector<bool>(chunksY, false)};
 }
 
-void Exploration::writeTo(XmlWriter &xw) const {
-  auto e = xw.addChild("mapExploration");
+void Exploration::writeTo(XmlStreamWriter &xw) const {
+  xw.openElement("mapExploration");
   auto chunksX = _map.size();
   for (auto x = 0; x != chunksX; ++x) {
     auto data = ""s;
     for (auto y = 0; y != _map[x].size(); ++y) {
       data.push_back(_map[x][y] ? ' ' : 'X');
     }
-    auto col = xw.addChild("col", e);
-    xw.setAttr(col, "data", data);
+    xw.openElement("col");
+    xw.setAttr("data", data);
+    xw.closeElement();
   }
+  xw.closeElement();
 }
 
 void Exploration::readFrom(XmlReader &xr) {
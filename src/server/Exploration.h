@@ -6,7 +6,7 @@
 
 class Socket;
 class XmlReader;
-class XmlWriter;
+class XmlStreamWriter;
 
 // Contained in User
 class Exploration {
@@ -17,7 +17,7 @@ class Exploration {
 
   Exploration(size_t mapWidth, size_t mapHeight);
 
-  void writeTo(XmlWriter &xw) const;
+  void writeTo(XmlStreamWriter &xw) const;
   void readFrom(XmlReader &xr);
 
   int numChunksExplored() const { return _numChunksExplored; }
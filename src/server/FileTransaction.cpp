@@ -0,0 +1,137 @@
+#include "FileTransaction.h"
+
+#include <io.h>
+#include <windows.h>
+
+#include "../parallel.h"
+#include "Server.h"
+
+namespace {
+
+// Wait until the file's contents are on disk.
+bool sync(FILE *file) {
+  return fflush(file) == 0 && _commit(_fileno(file)) == 0;
+}
+
+bool syncAll(const std::vector<FILE *> &files) {
+  auto wasSynced = std::vector<char>(files.size(), false);
+  parallelFor(
+      files.size(), [&](size_t i) { wasSynced[i] = sync(files[i]); },
+      "File syncer");
+  for (auto synced : wasSynced)
+    if (!synced) return false;
+  return true;
+}
+
+}  // namespace
+
+FileTransaction::~FileTransaction() { abandon(); }
+
+void FileTransaction::replace(const std::string &filename,
+                              const std::string &contents) {
+  auto tempFilename = filename + ".tmp";
+  auto *file = fopen(tempFilename.c_str(), "wb");
+  auto wasWritten = file != nullptr && fwrite(contents.data(), 1,
+                                              contents.size(),
+                                              file) == contents.size();
+  if (!wasWritten) reportFailure(filename);
+
+#ifndef SINGLE_THREAD
+  auto lock = std::unique_lock<std::mutex>{_mutex};
+#endif
+  if (!wasWritten) _hasFailed = true;
+  _replacements.push_back({filename, std::move(tempFilename), file});
+}
+
+void FileTransaction::append(const std::string &filename,
+                             const std::string &contents) {
+#ifndef SINGLE_THREAD
+  auto lock = std::unique_lock<std::mutex>{_mutex};
+#endif
+  _appends.push_back({filename, contents});
+}
+
+void FileTransaction::remove(const std::string &filename) {
+#ifndef SINGLE_THREAD
+  auto lock = std::unique_lock<std::mutex>{_mutex};
+#endif
+  _removals.push_back(filename);
+}
+
+bool FileTransaction::commit() {
+  // Every replacement must be safely on disk before any is renamed.
+  auto tempFiles = std::vector<FILE *>{};
+  for (const auto &replacement : _replacements)
+    if (replacement.file) tempFiles.push_back(replacement.file);
+  if (_hasFailed || !syncAll(tempFiles)) {
+    abandon();
+    return false;
+  }
+
+  auto succeeded = true;
+  for (auto &replacement : _replacements) {
+    fclose(replacement.file);
+    replacement.file = nullptr;
+    if (!MoveFileExA(replacement.tempFilename.c_str(),
+                     replacement.filename.c_str(),
+                     MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH)) {
+      reportFailure(replacement.filename);
+      ::remove(replacement.tempFilename.c_str());
+      succeeded = false;
+      break;
+    }
+  }
+  discardReplacements();
+
+  // Appends may refer to what the replacements hold (e.g., log entries
+  // tagged with a manifest's generation).
+  if (!succeeded) {
+    abandon();
+    return false;
+  }
+
+  auto appendedFiles = std::vector<FILE *>{};
+  for (const auto &append : _appends) {
+    auto *file = fopen(append.filename.c_str(), "ab");
+    if (!file) {
+      reportFailure(append.filename);
+      succeeded = false;
+      continue;
+    }
+    if (fwrite(append.contents.data(), 1, append.contents.size(), file) !=
+        append.contents.size()) {
+      reportFailure(append.filename);
+      succeeded = false;
+    }
+    appendedFiles.push_back(file);
+  }
+  if (!syncAll(appendedFiles)) succeeded = false;
+  for (auto *file : appendedFiles) fclose(file);
+  _appends.clear();
+
+  // A file may only be unused because of a change that didn't happen.
+  if (succeeded)
+    for (const auto &filename : _removals) ::remove(filename.c_str());
+  _removals.clear();
+
+  return succeeded;
+}
+
+void FileTransaction::abandon() {
+  discardReplacements();
+  _appends.clear();
+  _removals.clear();
+}
+
+void FileTransaction::discardReplacements() {
+  for (auto &replacement : _replacements) {
+    if (!replacement.file) continue;
+    fclose(replacement.file);
+    ::remove(replacement.tempFilename.c_str());
+  }
+  _replacements.clear();
+}
+
+void FileTransaction::reportFailure(const std::string &filename) const {
+  Server::debug()("Failed to save "s + filename, Color::CHAT_ERROR);
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#ifndef SINGLE_THREAD
+#include <mutex>
+#endif
+
+// Changes to several files, made durable together.  Replacements are written
+// to temporary files as they are added.  commit() flushes them all to disk in
+// a single pass, and only once every one is safely written renames them over
+// the originals, in the order they were added, stopping at the first that
+// fails so that a later file (e.g., a manifest) is never put in place without
+// those before it.  A crash therefore leaves each file either wholly old or
+// wholly new.  Appends come next, and removals last, each only if all before
+// it worked.
+class FileTransaction {
+ public:
+  FileTransaction() {}
+  FileTransaction(const FileTransaction &) = delete;
+  ~FileTransaction();  // Abandons anything not committed
+
+  // These may be called from several threads at once.
+  void replace(const std::string &filename, const std::string &contents);
+  void append(const std::string &filename, const std::string &contents);
+  void remove(const std::string &filename);
+
+  // False if anything failed.  If a replacement couldn't be written, none
+  // apply; if one couldn't be renamed, only those before it do, and nothing
+  // is appended.
+  bool commit();
+
+ private:
+  struct Replacement {
+    std::string filename;
+    std::string tempFilename;
+    FILE *file;  // Written and flushed, but not yet synced
+  };
+  struct Append {
+    std::string filename;
+    std::string contents;
+  };
+
+  void abandon();
+  void discardReplacements();  // Closes and deletes any remaining temp files
+  void reportFailure(const std::string &filename) const;
+
+  std::vector<Replacement> _replacements;
+  std::vector<Append> _appends;
+  std::vector<std::string> _removals;
+  bool _hasFailed{false};
+
+#ifndef SINGLE_THREAD
+  std::mutex _mutex;
+#endif
+};
@@ -29,7 +29,10 @@ void Gatherable::removeAllGatheringUsers() {
     user->sendMessage({SV_OBJECT_NOT_BEING_GATHERED, parent().serial()});
 }
 
-void Gatherable::setContents(const ItemSet &contents) { _contents = contents; }
+void Gatherable::setContents(const ItemSet &contents) {
+  _contents = contents;
+  parent().markAsChanged();
+}
 
 void Gatherable::removeItem(const ServerItem *item, size_t qty) {
   if (_contents[item] < qty) {
@@ -41,6 +44,7 @@ void Gatherable::removeItem(const ServerItem *item, size_t qty) {
         "Attempting to remove contents when total quantity is insufficient");
   }
   _contents.remove(item, qty);
+  parent().markAsChanged();
 }
 
 void Gatherable::populateContents() {
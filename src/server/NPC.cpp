@@ -10,12 +10,13 @@ NPC::NPC(const NPCType *type, const MapPoint &loc)
       _timeSinceLookedForTargets(rand() % AI::FREQUENCY_TO_LOOK_FOR_TARGETS),
       _disappearTimer(type->disappearsAfter()),
       ai(*this) {
+  classTag('n');
   _loot.reset(new Loot);
   onSetType();
 }
 
 void NPC::update(ms_t timeElapsed) {
-  if (health() > 0 && !isStunned()) ai.process(timeElapsed);
+  if (health() > 0 && !isStunned()) ai.update(timeElapsed);
 
   if (_disappearTimer > 0) {
     if (timeElapsed > _disappearTimer)
@@ -95,7 +96,7 @@ void NPC::makeNearbyNPCsAwareOf(Entity &entity) {
   auto nearbyEntities =
       server.findEntitiesInArea(location(), CHAIN_PULL_DISTANCE);
   for (auto nearbyEntity : nearbyEntities) {
-    auto npc = dynamic_cast<NPC *>(nearbyEntity);
+    auto npc = nearbyEntity->as<NPC>();
     if (!npc) continue;
 
     // Skip chain pulling for neutral NPCs
@@ -208,6 +209,13 @@ void NPC::forgetAbout(const Entity &entity) {
   _threatTable.forgetAbout(entity);
 }
 
+void NPC::followTarget(const User *newTarget) {
+  if (newTarget == _followTarget) return;
+  if (_followTarget) References::remove(*this, *_followTarget);
+  _followTarget = newTarget;
+  if (_followTarget) References::add(*this, *_followTarget);
+}
+
 double NPC::getTameChance() const {
   return getTameChanceBasedOnHealthPercent(1.0 * health() / stats().maxHealth);
 }
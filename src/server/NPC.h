@@ -26,7 +26,7 @@ class NPC : public Entity, public QuestNode {
   virtual ~NPC() {}
 
   const NPCType *npcType() const {
-    return dynamic_cast<const NPCType *>(type());
+    return static_cast<const NPCType *>(type());
   }
 
   AI ai;
@@ -41,6 +41,7 @@ class NPC : public Entity, public QuestNode {
   void scaleThreatAgainst(Entity &target, double multiplier) override;
   void makeAwareOf(Entity &entity);
   bool isAwareOf(Entity &entity) const;
+  bool isAwareOfAnyone() const { return !_threatTable.isEmpty(); }
   void forgetAbout(const Entity &entity);
   void makeNearbyNPCsAwareOf(Entity &entity);
   void addThreat(User &attacker, Threat amount);
@@ -50,6 +51,7 @@ class NPC : public Entity, public QuestNode {
   Permissions::Owner owner() const { return permissions.owner(); }
   virtual void onOwnershipChange() override;
   const User *followTarget() const { return _followTarget; }
+  void followTarget(const User *newTarget);
 
   void updateStats() override;
   void onHealthChange() override;
@@ -66,14 +68,14 @@ class NPC : public Entity, public QuestNode {
   bool grantsXPOnDeath() const override { return type()->rewardsXP; }
   double getTameChance() const;
 
-  char classTag() const override { return 'n'; }
+  static bool hasClassTag(char tag) { return tag == 'n'; }
 
   void sendInfoToClient(const User &targetUser,
                         bool isNew = false) const override;
   ServerItem::Slot *getSlotToTakeFromAndSendErrors(size_t slotNum,
                                                    const User &user) override;
 
-  void writeToXML(XmlWriter &xw) const override;
+  bool getSavedState(SavedEntity &saved) const override;
 
   void update(ms_t timeElapsed);
 
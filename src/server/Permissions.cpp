@@ -37,6 +37,7 @@ void Permissions::setNoAccess() {
   _owner.name = {};
 
   ownerIndex.add(_owner, parent().serial());
+  parent().markAsChanged();
 
   alertNearbyUsersToNewOwner();
   parent().onOwnershipChange();
@@ -49,6 +50,7 @@ void Permissions::setOwner(const Owner &newOwner) {
   _owner = newOwner;
 
   ownerIndex.add(_owner, parent().serial());
+  parent().markAsChanged();
 
   alertNearbyUsersToNewOwner();
   parent().onOwnershipChange();
@@ -17,6 +17,7 @@ ProgressLock::ProgressLock(Type triggerType, const std::string &triggerID,
       _chance(chance) {}
 
 void ProgressLock::registerStagedLocks() {
+  locksByType.clear();  // In case data has been reloaded
   for (ProgressLock lock : stagedLocks) {
     const Server &server = Server::instance();
     switch (lock._triggerType) {
@@ -0,0 +1,84 @@
+#include "PublishedStats.h"
+
+#include "User.h"
+
+PublishedStats::UserSummary PublishedStats::summarise(const User &user) {
+  auto summary = UserSummary{};
+  summary.classID = &user.getClass() ? user.getClass().type().id() : "None";
+  summary.level = user.level();
+  summary.completedQuests = user.questsCompleted();
+  summary.knownRecipes = static_cast<int>(user.knownRecipes().size());
+  summary.knownConstructions =
+      static_cast<int>(user.knownConstructions().size());
+  summary.chunksExplored = user.exploration.numChunksExplored();
+  return summary;
+}
+
+void PublishedStats::addOfflineUser(const User &user, std::string entry) {
+  replaceSummary(user.name(), summarise(user));
+  _offlineUserEntries[user.name()] = std::move(entry);
+  _offlineUserEntriesChanged = true;
+}
+
+void PublishedStats::userLoggedIn(const User &user) {
+  replaceSummary(user.name(), summarise(user));
+  if (_offlineUserEntries.erase(user.name()) == 1)
+    _offlineUserEntriesChanged = true;
+}
+
+void PublishedStats::userLoggedOut(const User &user, std::string entry) {
+  addOfflineUser(user, std::move(entry));
+}
+
+void PublishedStats::userProgressed(const User &user) {
+  replaceSummary(user.name(), summarise(user));
+}
+
+void PublishedStats::replaceSummary(const std::string &name,
+                                    UserSummary summary) {
+  auto it = _summaries.find(name);
+  if (it != _summaries.end()) addToTotals(it->second, -1);
+  addToTotals(summary, 1);
+  _summaries[name] = std::move(summary);
+}
+
+void PublishedStats::addToTotals(const UserSummary &summary, int sign) {
+  _accountsByClass[summary.classID] += sign;
+  _accountsByLevel[summary.level] += sign;
+  for (const auto &questID : summary.completedQuests)
+    _questCompletions[questID] += sign;
+  _recipesKnown += sign * summary.knownRecipes;
+  _constructionsKnown += sign * summary.knownConstructions;
+  _chunksExplored += sign * summary.chunksExplored;
+}
+
+template <typename K>
+static void writeCounts(std::ostream &stream, const char *name,
+                        const std::map<K, int> &counts) {
+  stream << name << ": {";
+  for (const auto &pair : counts) {
+    if (pair.second == 0) continue;
+    stream << "\"" << pair.first << "\": " << pair.second << ",";
+  }
+  stream << "},\n";
+}
+
+void PublishedStats::writeTotals(std::ostream &stream) const {
+  stream << "accounts: " << _summaries.size() << ",\n";
+  writeCounts(stream, "accountsByClass", _accountsByClass);
+  writeCounts(stream, "accountsByLevel", _accountsByLevel);
+  writeCounts(stream, "questCompletions", _questCompletions);
+  stream << "recipesKnown: " << _recipesKnown << ",\n";
+  stream << "constructionsKnown: " << _constructionsKnown << ",\n";
+  stream << "chunksExplored: " << _chunksExplored << ",\n";
+}
+
+const std::string &PublishedStats::offlineUserEntries() const {
+  if (_offlineUserEntriesChanged) {
+    _allOfflineUserEntries.clear();
+    for (const auto &pair : _offlineUserEntries)
+      _allOfflineUserEntries.append(pair.second);
+    _offlineUserEntriesChanged = false;
+  }
+  return _allOfflineUserEntries;
+}
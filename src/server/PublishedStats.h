@@ -0,0 +1,48 @@
+#pragma once
+
+#include <map>
+#include <ostream>
+#include <set>
+#include <string>
+
+#include "../combatTypes.h"
+#include "Quest.h"
+
+class User;
+
+// Totals across every account, for the stats page (logging/stats.js).  These
+// are kept up to date as users log in and out and make progress, so that
+// publishing doesn't have to revisit every account.  Offline users' entries
+// are rendered once, when they log out, and reused until they next log in.
+class PublishedStats {
+ public:
+  void addOfflineUser(const User &user, std::string entry);  // On startup
+  void userLoggedIn(const User &user);
+  void userLoggedOut(const User &user, std::string entry);
+  void userProgressed(const User &user);  // Level, quests, knowledge, map
+
+  void writeTotals(std::ostream &stream) const;
+  const std::string &offlineUserEntries() const;
+
+ private:
+  struct UserSummary {
+    std::string classID;
+    Level level{0};
+    std::set<Quest::ID> completedQuests;
+    int knownRecipes{0}, knownConstructions{0}, chunksExplored{0};
+  };
+  static UserSummary summarise(const User &user);
+  void replaceSummary(const std::string &name, UserSummary summary);
+  void addToTotals(const UserSummary &summary, int sign);
+
+  std::map<std::string, UserSummary> _summaries;  // Every account, by name
+
+  std::map<std::string, int> _accountsByClass;
+  std::map<Level, int> _accountsByLevel;
+  std::map<Quest::ID, int> _questCompletions;
+  long long _recipesKnown{0}, _constructionsKnown{0}, _chunksExplored{0};
+
+  std::map<std::string, std::string> _offlineUserEntries;  // Name -> entry
+  mutable std::string _allOfflineUserEntries;
+  mutable bool _offlineUserEntriesChanged{false};
+};
@@ -0,0 +1,47 @@
+#include "References.h"
+
+#include "Entity.h"
+
+void References::add(const Entity &referrer, const Entity &referenced) {
+  auto &from = const_cast<Entity &>(referrer);
+  auto &to = const_cast<Entity &>(referenced);
+  ++from.references._referenced[&to];
+  ++to.references._referrers[&from];
+}
+
+void References::remove(const Entity &referrer, const Entity &referenced) {
+  auto &from = const_cast<Entity &>(referrer);
+  auto &to = const_cast<Entity &>(referenced);
+
+  // Check the referrer's side first: if the link is already gone, then the
+  // referenced entity may have been destroyed and must not be touched.
+  if (!decrement(from.references._referenced, &to)) return;
+  decrement(to.references._referrers, &from);
+}
+
+void References::removeAllInvolving(const Entity &entity) {
+  auto &self = const_cast<Entity &>(entity);
+  auto &refs = self.references;
+
+  for (auto pair : refs._referenced)
+    pair.first->references._referrers.erase(&self);
+  for (auto pair : refs._referrers)
+    pair.first->references._referenced.erase(&self);
+
+  refs._referenced.clear();
+  refs._referrers.clear();
+}
+
+std::vector<Entity *> References::referrers() const {
+  auto ret = std::vector<Entity *>{};
+  ret.reserve(_referrers.size());
+  for (auto pair : _referrers) ret.push_back(pair.first);
+  return ret;
+}
+
+bool References::decrement(Counts &counts, Entity *key) {
+  auto it = counts.find(key);
+  if (it == counts.end()) return false;
+  if (--it->second <= 0) counts.erase(it);
+  return true;
+}
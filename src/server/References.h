@@ -0,0 +1,42 @@
+#pragma once
+
+#include <map>
+#include <vector>
+
+class Entity;
+
+/*
+ * Records which entities hold pointers to this entity (as a target, a
+ * threat-table entry, a buff caster, a follow target, a tagger or a gather
+ * target), and which entities this one points at in turn.  When an entity is
+ * removed, only its referrers need to be visited.
+ *
+ * Links are counted, since one entity may refer to another in several ways.
+ * Both directions are kept so that a destroyed entity can never be left
+ * dangling in another's list.
+ */
+class References {
+ public:
+  References() {}
+  // Copies start unlinked.
+  References(const References &) {}
+  References &operator=(const References &) { return *this; }
+
+  // Record that referrer holds a pointer to referenced.
+  static void add(const Entity &referrer, const Entity &referenced);
+  // Undo a single add().
+  static void remove(const Entity &referrer, const Entity &referenced);
+  // Sever every link to and from this entity, e.g. before it's destroyed.
+  static void removeAllInvolving(const Entity &entity);
+
+  // A copy, as visiting referrers will typically remove them.
+  std::vector<Entity *> referrers() const;
+  size_t numReferrers() const { return _referrers.size(); }
+
+ private:
+  using Counts = std::map<Entity *, int>;
+  Counts _referrers;   // Entities pointing at this one
+  Counts _referenced;  // Entities this one points at
+
+  static bool decrement(Counts &counts, Entity *key);
+};
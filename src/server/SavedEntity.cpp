@@ -0,0 +1,209 @@
+#include "SavedEntity.h"
+
+#include "../Item.h"
+#include "../XmlReader.h"
+#include "../XmlStreamWriter.h"
+#include "Server.h"
+
+static const char *elementName(SavedEntity::Kind kind) {
+  switch (kind) {
+    case SavedEntity::NPC:
+      return "npc";
+    case SavedEntity::DROPPED_ITEM:
+      return "droppedItem";
+    default:
+      return "object";
+  }
+}
+
+static bool readLocation(XmlReader &xr, TiXmlElement *elem, MapPoint &p) {
+  if (xr.findAttr(elem, "x", p.x) && xr.findAttr(elem, "y", p.y)) return true;
+
+  // Try old location format
+  auto location = xr.findChild("location", elem);
+  return location && xr.findAttr(location, "x", p.x) &&
+         xr.findAttr(location, "y", p.y);
+}
+
+bool SavedEntity::readFromXML(XmlReader &xr, TiXmlElement *elem) {
+  auto &debug = Server::debug();
+  const auto name = std::string{elem->Value()};
+  if (name == "object")
+    kind = OBJECT;
+  else if (name == "npc")
+    kind = NPC;
+  else if (name == "droppedItem")
+    kind = DROPPED_ITEM;
+  else {
+    debug << Color::CHAT_ERROR << "Skipping unknown entity \"" << name << "\"."
+          << Log::endl;
+    return false;
+  }
+
+  if (kind == DROPPED_ITEM) {
+    xr.findAttr(elem, "type", typeID);
+    xr.findAttr(elem, "qty", quantity);
+    if (!readLocation(xr, elem, location)) {
+      debug("Skipping importing dropped item with invalid/no location",
+            Color::CHAT_ERROR);
+      return false;
+    }
+    xr.findAttr(elem, "serial", serial);
+    return true;
+  }
+
+  if (!xr.findAttr(elem, "id", typeID)) {
+    debug(kind == NPC ? "Skipping importing NPC with no type."
+                      : "Skipping importing object with no type.",
+          Color::CHAT_ERROR);
+    return false;
+  }
+
+  if (!readLocation(xr, elem, location)) {
+    debug("Skipping importing object with invalid/no location",
+          Color::CHAT_ERROR);
+    return false;
+  }
+
+  xr.findAttr(elem, "serial", serial);
+
+  auto ownerElem = xr.findChild("owner", elem);
+  if (ownerElem) {
+    auto type = ""s;
+    xr.findAttr(ownerElem, "type", type);
+    xr.findAttr(ownerElem, "name", owner.name);
+    if (type == "player")
+      owner.type = Permissions::Owner::PLAYER;
+    else if (type == "city")
+      owner.type = Permissions::Owner::CITY;
+    else if (type == "noAccess")
+      owner.type = Permissions::Owner::NO_ACCESS;
+    else
+      debug << Color::CHAT_ERROR << "Skipping bad "
+            << (kind == NPC ? "NPC" : "object") << " owner type \"" << type
+            << "\"." << Log::endl;
+  }
+
+  hasHealth = xr.findAttr(elem, "health", health);
+  xr.findAttr(elem, "corpseTime", corpseTime);
+  xr.findAttr(elem, "transformTime", transformTime);
+
+  auto orderString = ""s;
+  if (xr.findAttr(elem, "order", orderString))
+    order = orderString == "stay" ? ORDER_TO_STAY : ORDER_TO_FOLLOW;
+
+  for (auto content : xr.getChildren("gatherable", elem)) {
+    auto gatherable = ItemQuantity{};
+    if (!xr.findAttr(content, "id", gatherable.itemID)) continue;
+    xr.findAttr(content, "quantity", gatherable.quantity);
+    gatherables.push_back(gatherable);
+  }
+
+  for (auto inventoryElem : xr.getChildren("inventory", elem)) {
+    auto slot = InventorySlot{};
+    if (!xr.findAttr(inventoryElem, "item", slot.itemID)) continue;
+    if (!xr.findAttr(inventoryElem, "slot", slot.slot)) continue;
+    xr.findAttr(inventoryElem, "qty", slot.quantity);
+    // Default value to support transition of old data
+    slot.health = Item::MAX_HEALTH;
+    xr.findAttr(inventoryElem, "health", slot.health);
+    auto n = 0;
+    slot.isSoulbound = xr.findAttr(inventoryElem, "soulbound", n) && n != 0;
+    inventory.push_back(slot);
+  }
+
+  for (auto merchant : xr.getChildren("merchant", elem)) {
+    auto ware = Ware{};
+    if (!xr.findAttr(merchant, "slot", ware.slot)) continue;
+    if (!xr.findAttr(merchant, "wareItem", ware.wareItemID) ||
+        !xr.findAttr(merchant, "priceItem", ware.priceItemID))
+      continue;
+    xr.findAttr(merchant, "wareQty", ware.wareQuantity);
+    xr.findAttr(merchant, "priceQty", ware.priceQuantity);
+    wares.push_back(ware);
+  }
+
+  for (auto material : xr.getChildren("material", elem)) {
+    auto remaining = ItemQuantity{};
+    if (!xr.findAttr(material, "id", remaining.itemID)) continue;
+    if (!xr.findAttr(material, "qty", remaining.quantity)) continue;
+    remainingMaterials.push_back(remaining);
+  }
+
+  auto vehicle = xr.findChild("vehicle", elem);
+  if (vehicle) xr.findAttr(vehicle, "driver", driver);
+
+  return true;
+}
+
+void SavedEntity::writeToXML(XmlStreamWriter &xw, unsigned generation) const {
+  xw.openElement(elementName(kind));
+
+  if (kind == DROPPED_ITEM) {
+    xw.setAttr("type", typeID);
+    if (quantity > 1) xw.setAttr("qty", quantity);
+  } else
+    xw.setAttr("id", typeID);
+
+  xw.setAttr("x", location.x);
+  xw.setAttr("y", location.y);
+
+  if (serial.isInitialised()) xw.setAttr("serial", serial.raw());
+  xw.setAttr("generation", generation);
+
+  if (hasHealth) xw.setAttr("health", health);
+  if (corpseTime > 0) xw.setAttr("corpseTime", corpseTime);
+  if (transformTime > 0) xw.setAttr("transformTime", transformTime);
+
+  if (order != NO_ORDER)
+    xw.setAttr("order", order == ORDER_TO_STAY ? "stay" : "follow");
+
+  if (owner) {
+    xw.openElement("owner");
+    xw.setAttr("type", owner.typeString());
+    xw.setAttr("name", owner.name);
+    xw.closeElement();
+  }
+
+  for (const auto &gatherable : gatherables) {
+    xw.openElement("gatherable");
+    xw.setAttr("id", gatherable.itemID);
+    xw.setAttr("quantity", gatherable.quantity);
+    xw.closeElement();
+  }
+
+  for (const auto &slot : inventory) {
+    xw.openElement("inventory");
+    xw.setAttr("slot", slot.slot);
+    xw.setAttr("item", slot.itemID);
+    if (slot.quantity > 1) xw.setAttr("qty", slot.quantity);
+    xw.setAttr("health", slot.health);
+    if (slot.isSoulbound) xw.setAttr("soulbound", 1);
+    xw.closeElement();
+  }
+
+  for (const auto &ware : wares) {
+    xw.openElement("merchant");
+    xw.setAttr("slot", ware.slot);
+    xw.setAttr("wareItem", ware.wareItemID);
+    xw.setAttr("wareQty", ware.wareQuantity);
+    xw.setAttr("priceItem", ware.priceItemID);
+    xw.setAttr("priceQty", ware.priceQuantity);
+    xw.closeElement();
+  }
+
+  for (const auto &material : remainingMaterials) {
+    xw.openElement("material");
+    xw.setAttr("id", material.itemID);
+    xw.setAttr("qty", material.quantity);
+    xw.closeElement();
+  }
+
+  if (!driver.empty()) {
+    xw.openElement("vehicle");
+    xw.setAttr("driver", driver);
+    xw.closeElement();
+  }
+
+  xw.closeElement();
+}
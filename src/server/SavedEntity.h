@@ -0,0 +1,67 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "../Point.h"
+#include "../Serial.h"
+#include "../combatTypes.h"
+#include "../types.h"
+#include "Permissions.h"
+
+class TiXmlElement;
+class XmlReader;
+class XmlStreamWriter;
+
+// The persistent state of one entity, independent of how it is stored.  World
+// files of every format are decoded into these before any entity is created,
+// and entities describe themselves with these to be saved.  Items are
+// identified by ID, so that a record can outlive the data it refers to.
+struct SavedEntity {
+  enum Kind : unsigned char { OBJECT, NPC, DROPPED_ITEM };
+  enum Order : unsigned char { NO_ORDER, ORDER_TO_FOLLOW, ORDER_TO_STAY };
+
+  struct ItemQuantity {
+    std::string itemID;
+    size_t quantity{1};
+  };
+  struct InventorySlot {
+    size_t slot{0};
+    std::string itemID;
+    size_t quantity{1};
+    Hitpoints health{0};
+    bool isSoulbound{false};
+  };
+  struct Ware {
+    size_t slot{0};
+    std::string wareItemID;
+    size_t wareQuantity{1};
+    std::string priceItemID;
+    size_t priceQuantity{1};
+  };
+
+  Kind kind{OBJECT};
+  std::string typeID;  // The item type, for dropped items
+  MapPoint location;
+  Serial serial;  // When it was saved; uninitialised for authored entities
+
+  bool hasHealth{false};
+  Hitpoints health{0};
+  ms_t corpseTime{0};
+  ms_t transformTime{0};
+  Permissions::Owner owner;
+
+  std::vector<ItemQuantity> gatherables;
+  std::vector<InventorySlot> inventory;
+  std::vector<Ware> wares;
+  std::vector<ItemQuantity> remainingMaterials;
+  std::string driver;
+
+  Order order{NO_ORDER};
+
+  size_t quantity{1};  // Dropped items only
+
+  // False, with an error logged, if the element can't describe an entity.
+  bool readFromXML(XmlReader &xr, TiXmlElement *elem);
+  void writeToXML(XmlStreamWriter &xw, unsigned generation) const;
+};
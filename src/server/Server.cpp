@@ -8,6 +8,7 @@
 
 #include "../Socket.h"
 #include "../messageCodes.h"
+#include "../parallel.h"
 #include "../threadNaming.h"
 #include "../util.h"
 #include "../versionUtil.h"
@@ -59,7 +60,17 @@ Server::Server()
 
   if (cmdLineArgs.contains("user-files-path"))
     _userFilesPath = cmdLineArgs.getString("user-files-path") + "/";
-  if (cmdLineArgs.contains("new")) deleteUserFiles();
+  const auto accountStoreFile = _userFilesPath + "accounts.dat";
+  const auto accountStoreIsNew = !fileExists(accountStoreFile);
+  _accounts.open(accountStoreFile);
+  if (cmdLineArgs.contains("new"))
+    _accounts.clear();
+  else if (accountStoreIsNew || cmdLineArgs.contains("import-user-files")) {
+    auto numImported = _accounts.importUserFiles(_userFilesPath);
+    if (numImported > 0)
+      _debug("Imported "s + toString(numImported) +
+             " user files into the account store"s);
+  }
 
   // Socket details
   sockaddr_in serverAddr;
@@ -83,7 +94,7 @@ Server::Server()
 }
 
 Server::~Server() {
-  saveData(_entities, _wars, _cities);
+  saveWorld(SAVE_EVERYTHING);
   for (auto pair : _terrainTypes) delete pair.second;
   for (const auto &spellPair : _spells) delete spellPair.second;
   ProgressLock::cleanup();
@@ -181,10 +192,32 @@ void Server::run() {
   if (!_socket.isBound()) return;
 
   if (!_dataLoaded) DataLoader::FromPath(*this).load();
-  initialiseData();
-  if (isDebug()) Server::instance().generateDurabilityList();
-  loadWorldState();
-  if (!cmdLineArgs.contains("nospawn")) spawnInitialObjects();
+  {
+    auto phase = _startupProfile.phase("Initialising data");
+    initialiseData();
+    if (_dataSource.type == DataSource::FILES_PATH)
+      _dataReloader.noteFilesLoaded(_dataSource.string);
+  }
+  if (isDebug()) {
+    auto phase = _startupProfile.phase("Generating durability list");
+    Server::instance().generateDurabilityList();
+  }
+  {
+    auto phase = _startupProfile.phase("Loading world state");
+    loadWorldState();
+  }
+  if (!_isTestServer) {
+    auto phase = _startupProfile.phase("Summarising offline users");
+    summariseOfflineUsers();
+  }
+  if (!cmdLineArgs.contains("nospawn")) {
+    auto phase = _startupProfile.phase("Spawning initial objects");
+    spawnInitialObjects();
+  }
+  {
+    auto phase = _startupProfile.phase("Saving world");
+    saveWorld(SAVE_EVERYTHING);  // Folding in any changes replayed from the log
+  }
 
   auto threadsOpen = 0;
 
@@ -193,6 +226,7 @@ void Server::run() {
   _loop = true;
   _running = true;
   _debug("Server is ready", Color::CHAT_SUCCESS);
+  reportStartupProfile();
   while (_loop) {
     _time = SDL_GetTicks();
     const ms_t timeElapsed = _time - _lastTime;
@@ -227,34 +261,50 @@ void Server::run() {
     // Save data
     if (_time - _lastSave >= SAVE_FREQUENCY) {
       for (const User &user : _users) {
+        if (!user.hasUnsavedChanges()) continue;
         writeUserData(user);
+        const_cast<User &>(user).markAsSaved();
       }
 
-      std::thread([this]() {
-        setThreadName("Saving data on regular timer");
-        saveData(_entities, _wars, _cities);
-      }).detach();
+      requestWorldSave();
 
       _lastSave = _time;
     }
 
+    // Requests made since the last tick are combined into one snapshot.  If
+    // an earlier write failed, changes since marked as saved may not be on
+    // disk, and a full save's new generation may not have taken effect; only
+    // saving everything again recovers from that.
+    if (_worldSaveRequested) {
+      _worldSaveRequested = false;
+      auto shouldSaveEverything =
+          _worldSaver.needsCompleteSnapshot() ||
+          _time - _lastWorldCompaction >= WORLD_COMPACTION_FREQUENCY;
+      saveWorld(shouldSaveEverything ? SAVE_EVERYTHING : SAVE_CHANGES);
+    }
+
     // Publish stats
     if (!_isTestServer)
       if (_time - _timeStatsLastPublished >= PUBLISH_STATS_FREQUENCY) {
-        std::thread([this]() {
-          setThreadName("Publishing server stats");
-          publishStats();
-        }).detach();
-
+        publishStats();
         _timeStatsLastPublished = _time;
       }
 
+    // Apply any game data reloaded since the last tick
+    _dataReloader.update(_time);
+
     // Update users
     for (const User &user : _users)
       const_cast<User &>(user).update(timeElapsed);
 
-    // Update non-user entities
-    for (Entity *entP : _entities) entP->update(timeElapsed);
+    // Update non-user entities.  NPCs far from any user are left as they are.
+    updateActiveRegions();
+    for (Entity *entP : _entities) {
+      if (entP->classTag() == 'n' &&
+          !_activeRegions.isActive(entP->location()))
+        continue;
+      entP->update(timeElapsed);
+    }
 
     // Clean up dead objects
     for (Entity *entP : _entitiesToRemove) {
@@ -280,6 +330,7 @@ void Server::run() {
   for (const User &user : _users) {
     writeUserData(user);
   }
+  _userDataWriter.waitUntilIdle();
 
   while (_threadsOpen > 0)
     ;
@@ -288,11 +339,11 @@ void Server::run() {
 
 void Server::addUser(const Socket &socket, const std::string &name,
                      const std::string &pwHash, const std::string &classID) {
-  auto newUserToInsert = User{name, {}, &socket};
-
-  // Add new user to list
+  // Add new user to list.  It's constructed in place, as its components and
+  // References refer back to the entity that holds them.
   logNumberOfOnlineUsers();
-  std::set<User>::const_iterator it = _users.insert(newUserToInsert).first;
+  std::set<User>::const_iterator it =
+      _users.emplace(name, MapPoint{}, &socket).first;
   auto &newUser = const_cast<User &>(*it);
   _usersByName[name] = &*it;
   logNumberOfOnlineUsers();
@@ -310,7 +361,11 @@ void Server::addUser(const Socket &socket, const std::string &name,
   const bool userExisted = readUserData(newUser);
   const auto isNewUser = !userExisted;
   if (isNewUser) {
-    newUser.setClass(_classes[classID]);
+    // An unknown class is created, so it needs indexing too.
+    auto &classType = _classes[classID];
+    if (_classesByID.isBuilt() && !_classesByID.find(classID))
+      _classesByID.add(classID, &classType);
+    newUser.setClass(classType);
     newUser.moveToSpawnPoint(true);
     _debug << "New";
   } else {
@@ -318,6 +373,7 @@ void Server::addUser(const Socket &socket, const std::string &name,
     newUser.updateStats();
   }
   _debug << " user, " << name << " has logged in." << Log::endl;
+  _publishedStats.userLoggedIn(newUser);
 
   if (!_isTestServer) newUser.findRealWorldLocation();
 
@@ -457,6 +513,9 @@ void Server::removeUser(const std::set<User>::iterator &it) {
   // Save user data
   writeUserData(userToDelete);
 
+  userToDelete.timeLastOnline = time(nullptr);
+  _publishedStats.userLoggedOut(userToDelete, offlineUserEntry(userToDelete));
+
   getCollisionChunk(userToDelete.location())
       .removeEntity(userToDelete.serial());
   _usersByX.erase(&userToDelete);
@@ -547,39 +606,39 @@ bool Server::isEntityInRange(const Socket &client, const User &user,
 
 void Server::forceAllToUntarget(const Entity &target,
                                 const User *userToExclude) {
-  // Fix users targeting the entity
-  auto serial = target.serial();
-  for (const User &constUser : _users) {
-    User &user = const_cast<User &>(constUser);
-    if (&user == userToExclude) continue;
-    if (user.target() == &target) {
-      if (user.action() == User::ATTACK) user.finishAction();
-      user.target(nullptr);
-      continue;
-    }
-    if (user.action() == User::GATHER &&
-        user.actionObject()->serial() == serial) {
-      user.sendMessage(WARNING_DOESNT_EXIST);
-      user.cancelAction();
-      user.target(nullptr);
+  // Only entities that hold pointers to the target need fixing.
+  for (auto *pReferrer : target.references.referrers()) {
+    Entity &entity = *pReferrer;
+
+    // Fix users targeting/gathering the entity
+    auto *pUser = entity.as<User>();
+    if (pUser && pUser != userToExclude) {
+      User &user = *pUser;
+      if (user.target() == &target) {
+        if (user.action() == User::ATTACK) user.finishAction();
+        user.target(nullptr);
+      } else if (user.action() == User::GATHER &&
+                 user.actionObject() == &target) {
+        user.sendMessage(WARNING_DOESNT_EXIST);
+        user.cancelAction();
+        user.target(nullptr);
+      }
     }
-  }
-
-  for (const Entity *pEnt : _entities) {
-    Entity &entity = *const_cast<Entity *>(pEnt);
 
     // Fix buffs cast by entity
     for (auto &buff : entity.buffs()) buff.clearCasterIfEqualTo(target);
     for (auto &debuff : entity.debuffs()) debuff.clearCasterIfEqualTo(target);
 
-    // Fix NPCs targeting/aware of the entity
-    if (entity.classTag() != 'n') continue;
-    NPC &npc = dynamic_cast<NPC &>(entity);
-    npc.forgetAbout(target);
-    if (npc.target() && npc.target() == &target) npc.target(nullptr);
-
     // Fix entities tagged by the entity
     if (entity.tagger == target) entity.tagger.onDisconnect();
+
+    // Fix NPCs targeting/aware of/following the entity
+    auto *pNPC = entity.as<NPC>();
+    if (!pNPC) continue;
+    NPC &npc = *pNPC;
+    npc.forgetAbout(target);
+    if (npc.target() && npc.target() == &target) npc.target(nullptr);
+    if (npc.followTarget() == &target) npc.followTarget(nullptr);
   }
 }
 
@@ -592,6 +651,10 @@ void Server::removeEntity(Entity &ent, const User *userToExclude) {
   for (const User *userP : findUsersInArea(ent.location()))
     userP->sendMessage({SV_OBJECT_REMOVED, serial});
 
+  if (!ent.excludedFromPersistentState())
+    _entitiesRemovedSinceSave.insert(serial);
+  _entitiesWithUnsavedChanges.erase(serial);
+
   getCollisionChunk(ent.location()).removeEntity(serial);
   _entitiesByX.erase(&ent);
   _entitiesByY.erase(&ent);
@@ -629,14 +692,7 @@ void Server::gatherObject(Serial serial, User &user) {
   } else
     ent->gatherable.decrementGatheringUsers();
 
-#ifdef SINGLE_THREAD
-  saveData(_objects, _wars, _cities);
-#else
-  std::thread([this]() {
-    setThreadName("Saving data after gather");
-    saveData(_entities, _wars, _cities);
-  }).detach();
-#endif
+  requestWorldSave();
 }
 
 void Server::removeAllObjectsOwnedBy(const Permissions::Owner &owner) {
@@ -647,29 +703,63 @@ void Server::removeAllObjectsOwnedBy(const Permissions::Owner &owner) {
   }
 }
 
+void Server::updateActiveRegions() {
+  auto userLocations = std::vector<MapPoint>{};
+  userLocations.reserve(_users.size());
+  for (const User &user : _users) userLocations.push_back(user.location());
+  _activeRegions.update(userLocations);
+}
+
 void Server::spawnInitialObjects() {
   // From spawners
-  auto timeOfLastReport = SDL_GetTicks();
+  const auto startTime = SDL_GetTicks();
+  auto timeOfLastReport = startTime;
 
+  // Each spawner's locations are found in parallel, against the world as it
+  // was beforehand.  Each spawner gets its own engine, seeded here in order,
+  // so that the results don't depend on how the work is split between threads.
   auto numSpawners = _spawners.size();
-  auto i = 0;
-  for (auto &spawner : _spawners) {
+  auto seeds = std::vector<unsigned>(numSpawners);
+  for (auto &seed : seeds) seed = rand();
+  auto locations = std::vector<Spawner::Locations>(numSpawners);
+  parallelFor(numSpawners,
+              [&](size_t i) {
+                const auto &spawner = _spawners[i];
+                if (!spawner.type()) return;
+                auto engine = Spawner::RandomEngine{seeds[i]};
+                locations[i] =
+                    spawner.findSpawnLocations(spawner.quantity(), engine);
+              },
+              "Finding spawn locations");
+
+  // Entities are then added here, in spawner order.  A location taken in the
+  // meantime by another spawner is replaced with an ordinary spawn.
+  auto numSpawned = size_t{0};
+  for (auto i = size_t{0}; i != numSpawners; ++i) {
+    auto &spawner = _spawners[i];
     if (!spawner.type()) {
       SERVER_ERROR("Spawner has no type");
       return;
     }
-    for (size_t i = 0; i != spawner.quantity(); ++i) spawner.spawn();
-    ++i;
+    for (const auto &location : locations[i])
+      if (spawner.spawnAt(location)) ++numSpawned;
+    for (auto j = locations[i].size(); j < spawner.quantity(); ++j)
+      if (spawner.spawn()) ++numSpawned;
 
     const auto REPORTING_TIME = 500;
     auto currentTime = SDL_GetTicks();
     if (currentTime - timeOfLastReport >= REPORTING_TIME) {
       timeOfLastReport = currentTime;
-      _debug << Color::CHAT_DEFAULT << "Loading spawners: " << i << "/"
-             << numSpawners << " (" << 100 * i / numSpawners << "%)"
+      _debug << Color::CHAT_DEFAULT << "Loading spawners: " << i + 1 << "/"
+             << numSpawners << " (" << 100 * (i + 1) / numSpawners << "%)"
              << Log::endl;
     }
   }
+
+  const auto timeTaken = max<ms_t>(SDL_GetTicks() - startTime, 1);
+  _debug << Color::CHAT_DEFAULT << "Spawned " << numSpawned << " entities in "
+         << timeTaken << " ms (" << numSpawned * 1000 / timeTaken
+         << " per second)" << Log::endl;
 }
 
 bool Server::itemIsTag(const ServerItem *item,
@@ -682,6 +772,8 @@ bool Server::itemIsTag(const ServerItem *item,
 }
 
 ObjectType *Server::findObjectTypeByID(const std::string &id) const {
+  if (_objectTypesByID.isBuilt()) return _objectTypesByID.find(id);
+
   for (auto *type : _objectTypes)
     if (type->id() == id) return const_cast<ObjectType *>(type);
   return nullptr;
@@ -737,6 +829,7 @@ NPC &Server::addNPC(const NPCType *type, const MapPoint &location) {
 
 Entity &Server::addEntity(Entity *newEntity) {
   _entities.insert(newEntity);
+  newEntity->markAsChanged();
   const MapPoint &loc = newEntity->location();
 
   // Alert nearby users
@@ -765,18 +858,20 @@ User *Server::getUserByName(const std::string &username) {
 }
 
 const BuffType *Server::getBuffByName(const Buff::ID &id) const {
-  auto it = _buffTypes.find(id);
-  if (it == _buffTypes.end()) return nullptr;
-  return &it->second;
+  return findBuff(id);
 }
 
 const Quest *Server::findQuest(const Quest::ID &id) const {
+  if (_questsByID.isBuilt()) return _questsByID.find(id);
+
   auto it = _quests.find(id);
   if (it == _quests.end()) return nullptr;
   return &it->second;
 }
 
 const ServerItem *Server::findItem(const std::string &id) const {
+  if (_itemsByID.isBuilt()) return _itemsByID.find(id);
+
   auto dummy = ServerItem{id};
   auto it = _items.find(dummy);
   if (it == _items.end()) return nullptr;
@@ -785,21 +880,34 @@ const ServerItem *Server::findItem(const std::string &id) const {
 
 const ServerItem *Server::createAndFindItem(const std::string &id) {
   auto it = _items.insert(ServerItem{id}).first;
+  if (_itemsByID.isBuilt()) _itemsByID.add(id, &*it);
   return &*it;
 }
 
 const BuffType *Server::findBuff(const BuffType::ID &id) const {
+  if (_buffTypesByID.isBuilt()) return _buffTypesByID.find(id);
+
   auto it = _buffTypes.find(id);
   if (it == _buffTypes.end()) return nullptr;
   return &it->second;
 }
 
 const Spell *Server::findSpell(const Spell::ID &id) const {
+  if (_spellsByID.isBuilt()) return _spellsByID.find(id);
+
   auto it = _spells.find(id);
   if (it == _spells.end()) return nullptr;
   return it->second;
 }
 
+const ClassType *Server::findClass(const ClassType::ID &id) const {
+  if (_classesByID.isBuilt()) return _classesByID.find(id);
+
+  auto it = _classes.find(id);
+  if (it == _classes.end()) return nullptr;
+  return &it->second;
+}
+
 std::pair<std::set<Serial>::iterator, std::set<Serial>::iterator>
 Server::findObjectsOwnedBy(const Permissions::Owner &owner) const {
   return _objectsByOwner.getObjectsOwnedBy(owner);
@@ -816,6 +924,8 @@ const MapRect *Server::findNPCTemplate(const std::string &templateID) const {
 }
 
 const Recipe *Server::findRecipe(const std::string &recipeID) const {
+  if (_recipesByID.isBuilt()) return _recipesByID.find(recipeID);
+
   auto it = _recipes.find(recipeID);
   if (it == _recipes.end()) return nullptr;
   return &*it;
@@ -827,21 +937,6 @@ const Terrain *Server::terrainType(char index) const {
   return it->second;
 }
 
-void Server::deleteUserFiles() {
-  WIN32_FIND_DATAW fd;
-  std::wstring path(_userFilesPath.begin(), _userFilesPath.end());
-  std::replace(path.begin(), path.end(), '/', '\\');
-  std::wstring filter = path + L"*.usr";
-  path.c_str();
-  HANDLE hFind = FindFirstFileW(filter.c_str(), &fd);
-  if (hFind != INVALID_HANDLE_VALUE) {
-    do {
-      DeleteFileW((std::wstring(path.c_str()) + fd.cFileName).c_str());
-    } while (FindNextFileW(hFind, &fd));
-    FindClose(hFind);
-  }
-}
-
 void Server::makePlayerAKing(const User &user) {
   _kings.add(user.name());
   this->broadcastToArea(user.location(), {SV_KING, user.name()});
@@ -856,7 +951,11 @@ void Server::MoveAllObjectsFromOwnerToOwner(
   }
 }
 
-void Server::addObjectType(const ObjectType *p) { _objectTypes.insert(p); }
+void Server::addObjectType(const ObjectType *p) {
+  _objectTypes.insert(p);
+  if (_objectTypesByID.isBuilt())
+    _objectTypesByID.add(p->id(), const_cast<ObjectType *>(p));
+}
 
 void Server::initialiseData() {
   // Connect ranged weapons with their ammo
@@ -876,4 +975,64 @@ void Server::initialiseData() {
   }
 
   for (auto &ot : _objectTypes) ot->initialise();
+
+  indexTypes();
+}
+
+void Server::reinitialiseData(
+    const std::set<const EntityType *> &redefinedTypes) {
+  // As above, except that items stay put even if invalid, since users and
+  // objects may be holding them.
+  for (auto &itemConst : _items) {
+    auto &item = const_cast<ServerItem &>(itemConst);
+    item.fetchAmmoItem();
+  }
+
+  ProgressLock::registerStagedLocks();
+
+  for (auto &ot : _objectTypes) ot->initialise();
+
+  for (auto *entity : _entities)
+    if (redefinedTypes.count(entity->type())) entity->refreshCapabilities();
+
+  indexTypes();
+}
+
+const TerrainTileIndex &Server::terrainTileIndex(
+    const TerrainList &terrainList) {
+  auto &index = _terrainTileIndexes[&terrainList];
+  if (!index) index = std::make_unique<TerrainTileIndex>(_map, terrainList);
+  return *index;
+}
+
+void Server::clearTypeIndexes() {
+  _objectTypesByID.clear();
+  _itemsByID.clear();
+  _recipesByID.clear();
+  _buffTypesByID.clear();
+  _spellsByID.clear();
+  _questsByID.clear();
+  _classesByID.clear();
+}
+
+void Server::indexTypes() {
+  clearTypeIndexes();
+
+  for (auto *type : _objectTypes)
+    _objectTypesByID.add(type->id(), const_cast<ObjectType *>(type));
+  for (const auto &item : _items) _itemsByID.add(item.id(), &item);
+  for (const auto &recipe : _recipes) _recipesByID.add(recipe.id(), &recipe);
+  for (const auto &pair : _buffTypes)
+    _buffTypesByID.add(pair.first, &pair.second);
+  for (const auto &pair : _spells) _spellsByID.add(pair.first, pair.second);
+  for (const auto &pair : _quests) _questsByID.add(pair.first, &pair.second);
+  for (const auto &pair : _classes) _classesByID.add(pair.first, &pair.second);
+
+  _objectTypesByID.markAsBuilt();
+  _itemsByID.markAsBuilt();
+  _recipesByID.markAsBuilt();
+  _buffTypesByID.markAsBuilt();
+  _spellsByID.markAsBuilt();
+  _questsByID.markAsBuilt();
+  _classesByID.markAsBuilt();
 }
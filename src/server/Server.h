@@ -1,6 +1,7 @@
 #ifndef SERVER_H
 #define SERVER_H
 
+#include <atomic>
 #include <list>
 #include <queue>
 #include <set>
@@ -13,26 +14,38 @@
 #include "../Terrain.h"
 #include "../TerrainList.h"
 #include "../messageCodes.h"
+#include "AccountStore.h"
+#include "ActiveRegions.h"
 #include "Buff.h"
 #include "City.h"
 #include "Class.h"
 #include "CollisionChunk.h"
 #include "DataLoader.h"
+#include "DataReloader.h"
 #include "Entities.h"
 #include "ItemSet.h"
 #include "LogConsole.h"
 #include "NPC.h"
 #include "ObjectsByOwner.h"
+#include "PublishedStats.h"
 #include "Quest.h"
 #include "SRecipe.h"
 #include "ServerItem.h"
 #include "Spawner.h"
 #include "Spell.h"
+#include "StartupProfile.h"
+#include "TerrainTileIndex.h"
+#include "TypeIndex.h"
 #include "User.h"
+#include "UserDataWriter.h"
+#include "UserRecordCache.h"
 #include "Wars.h"
+#include "WorldSaver.h"
 #include "objects/Object.h"
 
+class DroppedItem;
 class Groups;
+struct SavedEntity;
 
 class MessageParser;
 
@@ -81,7 +94,7 @@ class Server {
                                    double squareRadius = CULL_DISTANCE) const;
   std::set<Entity *> findEntitiesInArea(
       MapPoint loc, double squareRadius = CULL_DISTANCE) const;
-  ObjectType *findObjectTypeByID(const std::string &id) const;  // Linear
+  ObjectType *findObjectTypeByID(const std::string &id) const;
   User *getUserByName(const std::string &username);
   const BuffType *getBuffByName(const Buff::ID &id) const;
   const Quest *findQuest(const Quest::ID &id) const;
@@ -89,6 +102,7 @@ class Server {
   const ServerItem *createAndFindItem(const std::string &id);
   const BuffType *findBuff(const BuffType::ID &id) const;
   const Spell *findSpell(const Spell::ID &id) const;
+  const ClassType *findClass(const ClassType::ID &id) const;
   std::pair<std::set<Serial>::iterator, std::set<Serial>::iterator>
   findObjectsOwnedBy(const Permissions::Owner &owner) const;
   Entity *findEntityBySerial(Serial serial);
@@ -194,7 +208,7 @@ class Server {
   // Pointers to all connected users, ordered by name for faster lookup
   mutable std::map<std::string, const User *> _usersByName;
   std::string _userFilesPath;
-  void deleteUserFiles();
+  mutable AccountStore _accounts;  // In _userFilesPath
   /*
   Add the newly logged-in user
   This happens not once the client connects, but rather when a CL_LOGIN_*
@@ -233,6 +247,10 @@ class Server {
   };
   void setDataSource(const DataSource &dataSource) { _dataSource = dataSource; }
 
+  // Rereads any data files changed since they were loaded.  They are parsed
+  // in the background, and applied between ticks.
+  void reloadData() { _dataReloader.start(); }
+
  private:
   DataSource _dataSource{DataSource::FILES_PATH, "Data"};
   void loadWorldState();  // Attempt to load data from files.
@@ -240,11 +258,47 @@ class Server {
                             bool shouldBeExcludedFromPersistentState);
   void loadEntitiesFromString(const std::string &data,
                               bool shouldBeExcludedFromPersistentState);
-  void loadEntities(XmlReader &xr, bool shouldBeExcludedFromPersistentState);
+  // Entities written by this server record their serials at the time, so
+  // that later change-log records can refer to them.
+  using EntitiesBySavedSerial = std::map<Serial, Entity *>;
+  void loadEntities(XmlReader &xr, bool shouldBeExcludedFromPersistentState,
+                    EntitiesBySavedSerial *savedSerials = nullptr);
+  Entity *loadEntity(XmlReader &xr, TiXmlElement *elem,
+                     bool shouldBeExcludedFromPersistentState,
+                     EntitiesBySavedSerial *savedSerials);
+  Entity *loadEntity(const SavedEntity &saved,
+                     bool shouldBeExcludedFromPersistentState);
+  Object *loadObject(const SavedEntity &saved,
+                     bool shouldBeExcludedFromPersistentState);
+  NPC *loadNPC(const SavedEntity &saved,
+               bool shouldBeExcludedFromPersistentState);
+  DroppedItem *loadDroppedItem(const SavedEntity &saved);
+  void loadSavedEntities();  // The last full snapshot, then the changes since
+  void replayWorldChangeLog(EntitiesBySavedSerial &savedSerials);
+  void applyWorldChangeRecord(XmlReader &xr, TiXmlElement *record,
+                              EntitiesBySavedSerial &savedSerials);
   void initialiseData();
+  // After a reload.  Entities of redefined types have their capabilities
+  // refreshed.
+  void reinitialiseData(const std::set<const EntityType *> &redefinedTypes);
   bool _dataLoaded{false};  // If false when run() is called, load default data.
-  static void saveData(const Entities &entities, const Wars &wars,
-                       const Cities &cities);
+  DataReloader _dataReloader{*this};
+  StartupProfile _startupProfile{[this]() { return _entities.size(); }};
+
+  // Saving the world.  Most saves append only the entities changed since the
+  // last save to a log; every so often the whole world is written instead,
+  // and the log emptied.
+  enum SaveScope { SAVE_CHANGES, SAVE_EVERYTHING };
+  std::unique_ptr<WorldSaver::Snapshot> snapshotWorld(SaveScope scope);
+  void saveWorld(SaveScope scope);  // The writing happens in the background.
+  void requestWorldSave() { _worldSaveRequested = true; }  // At next tick
+  std::atomic<bool> _worldSaveRequested{false};
+  WorldSaver _worldSaver;
+  std::set<Serial> _entitiesWithUnsavedChanges;
+  std::set<Serial> _entitiesRemovedSinceSave;
+  unsigned _worldGeneration{0};  // Incremented by each full save
+  static const ms_t WORLD_COMPACTION_FREQUENCY = 600000;
+  ms_t _lastWorldCompaction{0};
   void spawnInitialObjects();
   volatile mutable int _threadsOpen{0};
   Map _map;
@@ -264,9 +318,27 @@ class Server {
                  // dynamic-object storage.
   Quests _quests;
 
+  // Hash indexes into the registries above, for the find*() functions.
+  TypeIndex<ObjectType> _objectTypesByID;
+  TypeIndex<const ServerItem> _itemsByID;
+  TypeIndex<const SRecipe> _recipesByID;
+  TypeIndex<const BuffType> _buffTypesByID;
+  TypeIndex<const Spell> _spellsByID;
+  TypeIndex<const Quest> _questsByID;
+  TypeIndex<const ClassType> _classesByID;
+  void clearTypeIndexes();
+  void indexTypes();  // To be called once data has been loaded.
+
+  // Built when first needed, and cleared whenever the map is loaded.
+  std::map<const TerrainList *, std::unique_ptr<TerrainTileIndex>>
+      _terrainTileIndexes;
+  const TerrainTileIndex &terrainTileIndex(const TerrainList &terrainList);
+
   size_t _numBuildableObjects = 0;
 
   std::list<Entity *> _entitiesToRemove;  // Emptied every tick.
+  ActiveRegions _activeRegions;
+  void updateActiveRegions();
   void forceAllToUntarget(const Entity &target,
                           const User *userToExclude = nullptr);
   void removeEntity(Entity &ent, const User *userToExclude = nullptr);
@@ -275,6 +347,7 @@ class Server {
 
   friend class City;
   friend class DataLoader;
+  friend class DataReloader;
   friend class Entity;
   friend class NPC;
   friend class Object;
@@ -284,6 +357,7 @@ class Server {
   friend class Spawner;
   friend class TestServer;
   friend class User;
+  friend class Vehicle;
 
  public:
   NPC &addNPC(const NPCType *type, const MapPoint &location);
@@ -313,17 +387,26 @@ class Server {
  private:
   bool readUserData(User &user,
                     bool allowSideEffects = true);  // true: save data existed
-  void writeUserData(const User &user) const;
-  static const ms_t SAVE_FREQUENCY = 30000;
+  void writeUserData(const User &user) const;  // Queued for _userDataWriter
+  mutable UserDataWriter _userDataWriter{_accounts};
+  UserRecordCache::Record findUserRecord(const std::string &name) const;
+  static const size_t USER_RECORD_CACHE_SIZE = 500;
+  mutable UserRecordCache _userRecords{USER_RECORD_CACHE_SIZE};
+  static const ms_t SAVE_FREQUENCY = 30000;  // Only users with changes
   ms_t _lastSave;
 
-  void publishStats();
+  void publishStats() const;
   void generateDurabilityList();
+  void reportStartupProfile();
   static const ms_t PUBLISH_STATS_FREQUENCY = 5000;
   ms_t _timeStatsLastPublished;
+  mutable std::atomic<bool> _isWritingStats{false};  // One write at a time
+  PublishedStats _publishedStats;
+  void summariseOfflineUsers();  // Reads every account; done once, at startup
   void logNumberOfOnlineUsers() const;
 
   void writeUserToFile(const User &user, std::ostream &file) const;
+  std::string offlineUserEntry(const User &user) const;
 
   template <MessageCode M>
   void handleMessage(const Socket &client, User &user, MessageParser &parser);
@@ -0,0 +1,182 @@
+#include "ShardedWorldFile.h"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+#include "../XmlReader.h"
+#include "../XmlStreamWriter.h"
+#include "../parallel.h"
+#include "FileTransaction.h"
+#include "Server.h"
+
+namespace {
+
+struct ShardEntry {
+  std::string filename;
+  size_t numEntities{0};
+};
+
+struct Manifest {
+  bool isReadable{false};
+  std::string text;
+  unsigned generation{0};
+  std::vector<ShardEntry> shards;
+};
+
+Manifest readManifest(const std::string &filename) {
+  auto manifest = Manifest{};
+  auto file = std::ifstream{filename, std::ios_base::binary};
+  if (!file) return manifest;
+  std::ostringstream oss;
+  oss << file.rdbuf();
+  manifest.text = oss.str();
+
+  XmlReader xr;
+  if (!xr.newString(manifest.text)) return manifest;
+  auto generationElem = xr.findChild("generation");
+  if (!xr.findAttr(generationElem, "value", manifest.generation))
+    return manifest;
+  for (auto elem : xr.getChildren("shard")) {
+    auto entry = ShardEntry{};
+    xr.findAttr(elem, "file", entry.filename);
+    xr.findAttr(elem, "entities", entry.numEntities);
+    manifest.shards.push_back(entry);
+  }
+  manifest.isReadable = true;
+  return manifest;
+}
+
+bool isListed(const std::string &filename,
+              const std::vector<ShardEntry> &shards) {
+  return std::any_of(
+      shards.begin(), shards.end(),
+      [&](const ShardEntry &shard) { return shard.filename == filename; });
+}
+
+// Shards that are missing, damaged, or not the ones the manifest describes
+// are left empty, and listed as damaged.
+bool loadShards(const Manifest &manifest, std::vector<BinaryWorldFile> &shards,
+                std::vector<std::string> &damagedShards) {
+  shards.clear();
+  damagedShards.clear();
+  if (!manifest.isReadable) return false;
+
+  for (const auto &entry : manifest.shards) shards.emplace_back(entry.filename);
+  auto wasLoaded = std::vector<char>(shards.size(), false);
+  parallelFor(
+      shards.size(),
+      [&](size_t i) {
+        auto &shard = shards[i];
+        const auto &entry = manifest.shards[i];
+        wasLoaded[i] = shard.load() &&
+                       shard.generation() == manifest.generation &&
+                       shard.entities().size() == entry.numEntities;
+      },
+      "World loader");
+
+  for (auto i = size_t{0}; i != shards.size(); ++i) {
+    if (wasLoaded[i]) continue;
+    damagedShards.push_back(shards[i].filename());
+    shards[i] = BinaryWorldFile{shards[i].filename()};
+  }
+  return true;
+}
+
+}  // namespace
+
+ShardedWorldFile::ShardedWorldFile(const std::string &name,
+                                   double worldHeight)
+    : _name(name),
+      _manifestFilename(name + ".manifest"),
+      _previousManifestFilename(name + ".manifest.previous"),
+      _worldHeight(worldHeight) {
+  for (auto i = size_t{0}; i != NUM_SHARDS; ++i)
+    _shards.emplace_back(shardFilename(i));
+}
+
+std::string ShardedWorldFile::shardFilename(size_t index) const {
+  return _name + "."s + toString(_generation) + "."s + toString(index) +
+         ".bin"s;
+}
+
+void ShardedWorldFile::generation(unsigned g) {
+  _generation = g;
+  for (auto i = size_t{0}; i != _shards.size(); ++i) {
+    _shards[i].filename(shardFilename(i));
+    _shards[i].generation(g);
+  }
+}
+
+void ShardedWorldFile::add(SavedEntity &&entity) {
+  auto index = size_t{0};
+  if (_worldHeight > 0 && entity.location.y > 0) {
+    index = static_cast<size_t>(entity.location.y / _worldHeight * NUM_SHARDS);
+    index = std::min(index, NUM_SHARDS - 1);
+  }
+  _shards[index].add(std::move(entity));
+}
+
+void ShardedWorldFile::publish(FileTransaction &transaction) const {
+  const auto current = readManifest(_manifestFilename);
+  const auto previous = readManifest(_previousManifestFilename);
+
+  parallelFor(
+      _shards.size(),
+      [&](size_t i) {
+        transaction.replace(_shards[i].filename(), _shards[i].encode());
+      },
+      "World saver");
+
+  auto manifest = XmlStreamWriter::Document(_manifestFilename);
+  manifest.openElement("generation");
+  manifest.setAttr("value", _generation);
+  manifest.closeElement();
+  for (const auto &shard : _shards) {
+    manifest.openElement("shard");
+    manifest.setAttr("file", shard.filename());
+    manifest.setAttr("entities", shard.entities().size());
+    manifest.closeElement();
+  }
+
+  // Keep the current save to fall back on, in place of the one before it.
+  // A current save newer than this one was found damaged and passed over.
+  const auto shouldKeepCurrent =
+      current.isReadable && current.generation < _generation;
+  if (shouldKeepCurrent)
+    transaction.replace(_previousManifestFilename, current.text);
+  const auto &kept = shouldKeepCurrent ? current : previous;
+  const auto &discarded = shouldKeepCurrent ? previous : current;
+  for (const auto &entry : discarded.shards) {
+    auto isStillUsed = isListed(entry.filename, kept.shards) ||
+                       std::any_of(_shards.begin(), _shards.end(),
+                                   [&](const BinaryWorldFile &shard) {
+                                     return shard.filename() == entry.filename;
+                                   });
+    if (!isStillUsed) transaction.remove(entry.filename);
+  }
+
+  transaction.replace(_manifestFilename, manifest.contents());
+}
+
+bool ShardedWorldFile::load() {
+  const auto current = readManifest(_manifestFilename);
+  _generation = current.generation;
+  _isFromPreviousSave = false;
+  loadShards(current, _shards, _damagedShards);
+  if (current.isReadable && _damagedShards.empty()) return true;
+
+  // Fall back on the previous save, but only if it is wholly intact.
+  const auto previous = readManifest(_previousManifestFilename);
+  auto previousShards = std::vector<BinaryWorldFile>{};
+  auto previousDamage = std::vector<std::string>{};
+  if (loadShards(previous, previousShards, previousDamage) &&
+      previousDamage.empty()) {
+    _generation = previous.generation;
+    _shards = std::move(previousShards);
+    _isFromPreviousSave = true;
+    return true;
+  }
+
+  return current.isReadable;
+}
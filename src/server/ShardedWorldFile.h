@@ -0,0 +1,55 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "BinaryWorldFile.h"
+
+class FileTransaction;
+
+// The world's persistent entities, split by region into several binary files
+// ("shards") so that they can be encoded, written and read in parallel.  A
+// small manifest names the shards that make up the latest save, and is
+// replaced only once every one of them is safely written; a save cut short
+// leaves the previous one intact.
+//
+// The save before the latest is kept too.  If the latest turns out to be
+// damaged on load, the one before it is used instead, as long as it is wholly
+// intact.  Otherwise a damaged shard costs only the entities in its region.
+class ShardedWorldFile {
+ public:
+  static const size_t NUM_SHARDS = 16;
+
+  // The manifest is name + ".manifest".  When saving, shards cover equal
+  // horizontal bands of a world of the given height.
+  ShardedWorldFile(const std::string &name, double worldHeight = 0);
+
+  const std::string &filename() const { return _manifestFilename; }
+  unsigned generation() const { return _generation; }
+  void generation(unsigned g);
+  void add(SavedEntity &&entity);
+  const std::vector<BinaryWorldFile> &shards() const { return _shards; }
+
+  // The shards first, then the manifest
+  void publish(FileTransaction &transaction) const;
+  bool load();  // False if there is no readable save
+
+  // Shards of the latest save that were missing or damaged on load.  Unless
+  // the previous save was used instead, these were left empty.
+  const std::vector<std::string> &damagedShards() const {
+    return _damagedShards;
+  }
+  bool isFromPreviousSave() const { return _isFromPreviousSave; }
+
+ private:
+  std::string shardFilename(size_t index) const;
+
+  std::string _name;
+  std::string _manifestFilename;
+  std::string _previousManifestFilename;
+  double _worldHeight;
+  unsigned _generation{0};
+  std::vector<BinaryWorldFile> _shards;
+  std::vector<std::string> _damagedShards;
+  bool _isFromPreviousSave{false};
+};
@@ -8,103 +8,142 @@ Spawner::Spawner(const MapPoint &location, const ObjectType *type)
 
       _radius(0),
       _quantity(1),
-      _respawnTime(0),
-      _terrainCache(*this) {}
+      _respawnTime(0) {}
 
 void Spawner::initialise() {
-  if (_shouldUseTerrainCache) _terrainCache.cacheTiles();
+  if (_shouldUseTerrainCache) _terrainCache.cacheTiles(*this);
 }
 
 MapPoint Spawner::getRandomPoint() const {
   return getRandomPointInCircle(_location, _radius);
 }
 
-const Entity *Spawner::spawn() {
-  static const size_t MAX_ATTEMPTS = 50;
+bool Spawner::pickLocation(MapPoint &location,
+                           const RandomSource &random) const {
+  if (!_shouldUseTerrainCache) {
+    location = getRandomPointInCircle(_location, _radius, random);
+    return true;
+  }
+
+  auto tile = _terrainCache.pickRandomTile(random);
+  location = Map::randomPointInTile(tile.first, tile.second, random);
+  return distance(location, _location) <= _radius;
+}
+
+bool Spawner::canSpawnAt(const MapPoint &location) const {
+  Server &server = *Server::_instance;
+
+  // Check terrain whitelist
+  if (!_terrainWhitelist.empty()) {
+    char terrain = server.findTile(location);
+    if (_terrainWhitelist.find(terrain) == _terrainWhitelist.end())
+      return false;
+  }
+
+  // Check location validity
+  return server.isLocationValid(location, *_type);
+}
+
+Entity &Spawner::addEntityAt(const MapPoint &location) {
   Server &server = *Server::_instance;
 
+  Entity *entity;
+  if (_type->classTag() == 'n')
+    entity = &server.addNPC(dynamic_cast<const NPCType *>(_type), location);
+  else
+    entity = &server.addObject(dynamic_cast<const ObjectType *>(_type),
+                               location, {});
+  entity->spawner(this);
+  entity->excludeFromPersistentState();
+  return *entity;
+}
+
+const Entity *Spawner::spawn() {
   for (size_t attempt = 0; attempt != MAX_ATTEMPTS; ++attempt) {
     auto p = MapPoint{};
-    if (_shouldUseTerrainCache) {
-      auto tile = _terrainCache.pickRandomTile();
-      p = Map::randomPointInTile(tile.first, tile.second);
-
-      if (distance(p, _location) > _radius) continue;
-    } else
-      p = getRandomPoint();
-
-    // Check terrain whitelist
-    if (!_terrainWhitelist.empty()) {
-      char terrain = server.findTile(p);
-      if (_terrainWhitelist.find(terrain) == _terrainWhitelist.end()) continue;
-    }
-
-    // Check location validity
-    if (!server.isLocationValid(p, *_type)) continue;
-
-    // Add object;
-    Entity *entity;
-    if (_type->classTag() == 'n')
-      entity = &server.addNPC(dynamic_cast<const NPCType *>(_type), p);
-    else
-      entity =
-          &server.addObject(dynamic_cast<const ObjectType *>(_type), p, {});
-    entity->spawner(this);
-    entity->excludeFromPersistentState();
-    return entity;
+    if (!pickLocation(p, randDouble)) continue;
+    if (!canSpawnAt(p)) continue;
+    return &addEntityAt(p);
   }
 
+  Server &server = *Server::_instance;
   server._debug << Color::CHAT_ERROR << "Failed to spawn " << _type->id()
                 << Log::endl;
   scheduleSpawn();
   return nullptr;
 }
 
+Spawner::Locations Spawner::findSpawnLocations(size_t quantity,
+                                               RandomEngine &engine) const {
+  auto locations = Locations{};
+  if (_shouldUseTerrainCache && _terrainCache.isEmpty())
+    return locations;  // spawn() will report it.
+
+  auto distribution = std::uniform_real_distribution<double>{0.0, 1.0};
+  const auto random = RandomSource{[&]() { return distribution(engine); }};
+
+  // The same checks as spawn(), plus this spawner's own earlier locations
+  auto claimed = std::vector<MapRect>{};
+  for (auto i = size_t{0}; i != quantity; ++i)
+    for (auto attempt = size_t{0}; attempt != MAX_ATTEMPTS; ++attempt) {
+      auto p = MapPoint{};
+      if (!pickLocation(p, random)) continue;
+      if (!canSpawnAt(p)) continue;
+
+      auto rect = _type->collisionRect() + p;
+      if (_type->collides()) {
+        auto overlapsClaimed = false;
+        for (const auto &claimedRect : claimed)
+          if (rect.overlaps(claimedRect)) {
+            overlapsClaimed = true;
+            break;
+          }
+        if (overlapsClaimed) continue;
+        claimed.push_back(rect);
+      }
+
+      locations.push_back(p);
+      break;
+    }
+
+  return locations;
+}
+
+const Entity *Spawner::spawnAt(const MapPoint &location) {
+  if (!canSpawnAt(location)) return spawn();
+  return &addEntityAt(location);
+}
+
 void Spawner::scheduleSpawn() {
   Log &d = Server::_instance->_debug;
   _spawnSchedule.push_back(SDL_GetTicks() + _respawnTime);
 }
 
 void Spawner::update(ms_t currentTime) {
+  // Respawns that fall due while no user is nearby wait until one is.
+  if (!Server::instance()._activeRegions.isActive(_location)) return;
+
   while (!_spawnSchedule.empty() && _spawnSchedule.front() <= currentTime) {
     _spawnSchedule.pop_front();
     spawn();
   }
 }
 
-void Spawner::TerrainCache::cacheTiles() {
-  const auto &terrainList = _owner.type()->allowedTerrain();
-
-  auto &server = Server::instance();
-  for (auto x = 0; x != server.map().width(); ++x)
-    for (auto y = 0; y != server.map().height(); ++y) {
-      // Check terrain is in list
-      auto terrainAtThisTile = server.map()[x][y];
-      if (!terrainList.allows(terrainAtThisTile)) continue;
-
-      // Check that it's inside the spawn point's radius
-      auto tileRect = server.map().getTileRect(x, y);
-      if (distance(tileRect, MapRect{_owner._location}) > _owner._radius)
-        continue;
-
-      registerValidTile(x, y);
-    }
-}
-
-Spawner::TerrainCache::TerrainCache(const Spawner &owner) : _owner(owner) {}
-
-void Spawner::TerrainCache::registerValidTile(size_t x, size_t y) {
-  auto &server = Server::instance();
-  auto tile = server.map().to1D(x, y);
-  _validTiles1D.push_back(tile);
+void Spawner::TerrainCache::cacheTiles(const Spawner &owner) {
+  const auto &terrainList = owner.type()->allowedTerrain();
+  const auto &index = Server::instance().terrainTileIndex(terrainList);
+  _validTiles1D = index.tilesNear(owner._location, owner._radius);
 }
 
-std::pair<size_t, size_t> Spawner::TerrainCache::pickRandomTile() const {
+std::pair<size_t, size_t> Spawner::TerrainCache::pickRandomTile(
+    const RandomSource &random) const {
   if (_validTiles1D.empty()) {
     SERVER_ERROR("No valid tiles for cached spawner");
     return {0, 0};
   }
-  auto randomIndex = rand() % _validTiles1D.size();
+  const auto numTiles = _validTiles1D.size();
+  auto randomIndex =
+      min(static_cast<size_t>(random() * numTiles), numTiles - 1);
   auto tile = _validTiles1D[randomIndex];
   return Server::instance().map().from1D(tile);
 }
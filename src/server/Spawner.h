@@ -2,7 +2,9 @@
 #define SPAWNER_H
 
 #include <list>
+#include <random>
 #include <set>
+#include <vector>
 
 #include "../Point.h"
 #include "../util.h"
@@ -30,16 +32,20 @@ class Spawner {
 
   class TerrainCache {
     std::vector<size_t> _validTiles1D;
-    const Spawner &_owner;
 
    public:
-    TerrainCache(const Spawner &owner);
-    void registerValidTile(size_t x, size_t y);
-    std::pair<size_t, size_t> pickRandomTile() const;
-    void cacheTiles();
+    bool isEmpty() const { return _validTiles1D.empty(); }
+    std::pair<size_t, size_t> pickRandomTile(const RandomSource &random) const;
+    void cacheTiles(const Spawner &owner);
   };
   TerrainCache _terrainCache;
 
+  static const size_t MAX_ATTEMPTS = 50;  // To find a valid location
+  // False if outside radius
+  bool pickLocation(MapPoint &location, const RandomSource &random) const;
+  bool canSpawnAt(const MapPoint &location) const;
+  Entity &addEntityAt(const MapPoint &location);
+
  public:
   Spawner(const MapPoint &location = MapPoint{},
           const ObjectType *type = nullptr);
@@ -55,6 +61,16 @@ class Spawner {
   void useTerrainCache() { _shouldUseTerrainCache = true; }
 
   const Entity *spawn();  // Attempt to add a new object.
+
+  // For spawning many at once.  Locations are found without changing the
+  // world, so several spawners can search at once, but no longer allow for
+  // each other; spawnAt() checks again, and falls back to spawn().  Each
+  // search draws from its own engine rather than rand(), so that its results
+  // don't depend on which thread runs it.
+  using Locations = std::vector<MapPoint>;
+  using RandomEngine = std::default_random_engine;
+  Locations findSpawnLocations(size_t quantity, RandomEngine &engine) const;
+  const Entity *spawnAt(const MapPoint &location);
   // Add a spawn job to the queue.  After _respawnTime, spawn() will be called.
   void scheduleSpawn();
   void update(ms_t currentTime);  // Act on any scheduled spawns that are due.
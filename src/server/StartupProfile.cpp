@@ -0,0 +1,148 @@
+#include "StartupProfile.h"
+
+#include <windows.h>
+
+#include <psapi.h>
+
+#include <sstream>
+
+StartupProfile::StartupProfile(EntityCounter countEntities)
+    : _countEntities(countEntities) {}
+
+StartupProfile::Phase::Phase(StartupProfile *profile, size_t index)
+    : _profile(profile), _index(index) {}
+
+StartupProfile::Phase::Phase(Phase &&rhs)
+    : _profile(rhs._profile), _index(rhs._index) {
+  rhs._profile = nullptr;
+}
+
+StartupProfile::Phase::~Phase() {
+  if (_profile) _profile->end(_index);
+}
+
+StartupProfile::Phase StartupProfile::phase(const std::string &name) {
+  const auto start = takeSample();
+#ifndef SINGLE_THREAD
+  auto lock = std::unique_lock<std::mutex>{_mutex};
+#endif
+  if (_isFinished) return {nullptr, 0};
+
+  auto record = Record{};
+  record.name = name;
+  record.depth = _depth++;
+  record.isPart = false;
+  record.start = start;
+  _records.push_back(record);
+  return {this, _records.size() - 1};
+}
+
+void StartupProfile::end(size_t index) {
+  const auto end = takeSample();
+#ifndef SINGLE_THREAD
+  auto lock = std::unique_lock<std::mutex>{_mutex};
+#endif
+  auto &record = _records[index];
+  const auto wallTime = end.wallTime - record.start.wallTime;
+  record.wallMS =
+      std::chrono::duration<double, std::milli>{wallTime}.count();
+  record.cpuMS = end.cpuMS - record.start.cpuMS;
+  record.memoryKB = end.memoryKB - record.start.memoryKB;
+  record.entities = end.entities - record.start.entities;
+  --_depth;
+}
+
+void StartupProfile::addPart(const std::string &name, double wallMS) {
+#ifndef SINGLE_THREAD
+  auto lock = std::unique_lock<std::mutex>{_mutex};
+#endif
+  if (_isFinished) return;
+
+  auto record = Record{};
+  record.name = name;
+  record.depth = _depth;
+  record.isPart = true;
+  record.wallMS = wallMS;
+  _records.push_back(record);
+}
+
+void StartupProfile::finish() {
+#ifndef SINGLE_THREAD
+  auto lock = std::unique_lock<std::mutex>{_mutex};
+#endif
+  _isFinished = true;
+}
+
+StartupProfile::Sample StartupProfile::takeSample() const {
+  auto sample = Sample{};
+  sample.wallTime = std::chrono::steady_clock::now();
+
+  // Kernel and user times are in units of 100 ns
+  auto creation = FILETIME{}, exit = FILETIME{}, kernel = FILETIME{},
+       user = FILETIME{};
+  if (GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user)) {
+    auto toTicks = [](const FILETIME &time) {
+      return (static_cast<unsigned long long>(time.dwHighDateTime) << 32) |
+             time.dwLowDateTime;
+    };
+    sample.cpuMS = (toTicks(kernel) + toTicks(user)) / 10000.0;
+  }
+
+  auto memory = PROCESS_MEMORY_COUNTERS_EX{};
+  if (GetProcessMemoryInfo(GetCurrentProcess(),
+                           reinterpret_cast<PROCESS_MEMORY_COUNTERS *>(&memory),
+                           sizeof(memory)))
+    sample.memoryKB = memory.PrivateUsage / 1024;
+
+  sample.entities = _countEntities();
+  return sample;
+}
+
+static std::string withSign(long long n) {
+  return (n > 0 ? "+" : "") + std::to_string(n);
+}
+
+std::vector<std::string> StartupProfile::reportLines() const {
+  auto lines = std::vector<std::string>{};
+
+  auto totalMS = 0.0;
+  for (const auto &record : _records)
+    if (record.depth == 0) totalMS += record.wallMS;
+  auto oss = std::ostringstream{};
+  oss.precision(0);
+  oss << std::fixed << "Startup took " << totalMS
+      << " ms (wall ms, CPU ms, memory KB, entities):";
+  lines.push_back(oss.str());
+
+  for (const auto &record : _records) {
+    oss.str("");
+    oss << std::string(2 * (record.depth + 1), ' ') << record.name << ": "
+        << record.wallMS;
+    if (!record.isPart)
+      oss << ", " << record.cpuMS << ", " << withSign(record.memoryKB) << ", "
+          << withSign(record.entities);
+    lines.push_back(oss.str());
+  }
+
+  return lines;
+}
+
+void StartupProfile::writeCSVRows(std::ostream &os, long long timeOfStartup,
+                                  const std::string &version) const {
+  // Each phase is named by its path, e.g. "Loading data/Parsing files"
+  auto path = std::vector<std::string>{};
+  for (const auto &record : _records) {
+    path.resize(record.depth);
+    path.push_back(record.name);
+    os << timeOfStartup << "," << version << ",";
+    for (auto i = size_t{0}; i != path.size(); ++i)
+      os << (i > 0 ? "/" : "") << path[i];
+    os << "," << record.wallMS;
+    if (record.isPart)
+      os << ",,,";
+    else
+      os << "," << record.cpuMS << "," << record.memoryKB << ","
+         << record.entities;
+    os << "\n";
+  }
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#ifndef SINGLE_THREAD
+#include <mutex>
+#endif
+
+// Where the time goes while the server starts up, phase by phase.  A phase
+// lasts as long as the object returned by phase(); one begun while another is
+// open is part of it.  Each records its wall time, the process's CPU time
+// (across all threads), the change in the process's private memory, and the
+// change in the number of entities.
+//
+// Once the server is ready the profile is finished, and later phases are
+// ignored.  It's reported as an indented list for the log, and as rows to be
+// appended to logging/startup.csv so that startups can be compared over time.
+class StartupProfile {
+ public:
+  using EntityCounter = std::function<size_t()>;
+  StartupProfile(EntityCounter countEntities);
+
+  class Phase {
+   public:
+    Phase(StartupProfile *profile, size_t index);  // Null if not recorded
+    Phase(Phase &&rhs);
+    ~Phase();  // Ends the phase
+    Phase(const Phase &) = delete;
+    Phase &operator=(const Phase &) = delete;
+
+   private:
+    StartupProfile *_profile;
+    size_t _index;
+  };
+  Phase phase(const std::string &name);
+
+  // A part of the open phase that was done on another thread, such as parsing
+  // a single file.  Only its wall time is known.  Safe to call from any
+  // thread.
+  void addPart(const std::string &name, double wallMS);
+
+  void finish();
+  bool isFinished() const { return _isFinished; }
+
+  std::vector<std::string> reportLines() const;
+  void writeCSVRows(std::ostream &os, long long timeOfStartup,
+                    const std::string &version) const;
+
+ private:
+  struct Sample {
+    std::chrono::steady_clock::time_point wallTime;
+    double cpuMS;
+    long long memoryKB;
+    long long entities;
+  };
+  Sample takeSample() const;
+  void end(size_t index);
+
+  struct Record {
+    std::string name;
+    size_t depth;
+    bool isPart;  // Only wall time is known.
+    Sample start;
+    double wallMS{0}, cpuMS{0};
+    long long memoryKB{0}, entities{0};  // Changes
+  };
+  std::vector<Record> _records;  // In the order they began
+  size_t _depth{0};
+  bool _isFinished{false};
+  EntityCounter _countEntities;
+
+#ifndef SINGLE_THREAD
+  std::mutex _mutex;
+#endif
+};
@@ -4,7 +4,7 @@
 #include "User.h"
 
 Tagger& Tagger::operator=(User& user) {
-  _user = &user;
+  setUser(&user);
   _username = user.name();
   return *this;
 }
@@ -23,7 +23,7 @@ bool Tagger::operator==(const Entity& rhs) const {
 
 void Tagger::clear() {
   _username = {};
-  _user = nullptr;
+  setUser(nullptr);
 }
 
 Tagger::operator bool() const { return isTagged(); }
@@ -35,11 +35,18 @@ User* Tagger::asUser() const {
 
 std::string Tagger::username() const { return _username; }
 
-void Tagger::onDisconnect() { _user = nullptr; }
+void Tagger::onDisconnect() { setUser(nullptr); }
 
 void Tagger::findUser() const {
   if (!isTagged()) return;
-  _user = Server::instance().getUserByName(_username);
+  setUser(Server::instance().getUserByName(_username));
+}
+
+void Tagger::setUser(User* user) const {
+  if (user == _user) return;
+  if (_user) References::remove(parent(), *_user);
+  _user = user;
+  if (_user) References::add(parent(), *_user);
 }
 
 bool Tagger::isTagged() const { return !_username.empty(); }
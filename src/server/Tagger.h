@@ -1,6 +1,7 @@
 #pragma once
 
 #include "../types.h"
+#include "EntityComponent.h"
 
 class User;
 class Entity;
@@ -9,8 +10,10 @@ class Entity;
  * Describes who will get credit for killing an entity.  Includes information
  * used for external logging of the kill.
  */
-class Tagger {
+class Tagger : public EntityComponent {
  public:
+  Tagger(Entity& parent) : EntityComponent(parent) {}
+
   Tagger& operator=(User& user);
   bool operator==(const User& rhs) const;
   bool operator==(const Entity& rhs) const;
@@ -23,6 +26,7 @@ class Tagger {
 
  private:
   void findUser() const;
+  void setUser(User* user) const;  // Also keeps References up to date
   bool isTagged() const;
   mutable User* _user{nullptr};
 
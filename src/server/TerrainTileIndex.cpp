@@ -0,0 +1,55 @@
+#include "TerrainTileIndex.h"
+
+#include <algorithm>
+
+#include "../Map.h"
+#include "../TerrainList.h"
+#include "../util.h"
+
+TerrainTileIndex::TerrainTileIndex(const Map &map,
+                                   const TerrainList &terrainList)
+    : _map(map) {
+  _chunksWide = (map.width() + CHUNK_SIZE - 1) / CHUNK_SIZE;
+  _chunksHigh = (map.height() + CHUNK_SIZE - 1) / CHUNK_SIZE;
+  _tilesByChunk.resize(_chunksWide * _chunksHigh);
+
+  for (auto y = size_t{0}; y != map.height(); ++y)
+    for (auto x = size_t{0}; x != map.width(); ++x) {
+      if (!terrainList.allows(map.at(x, y))) continue;
+      auto chunk = (y / CHUNK_SIZE) * _chunksWide + x / CHUNK_SIZE;
+      _tilesByChunk[chunk].push_back(map.to1D(x, y));
+    }
+}
+
+TerrainTileIndex::Tiles TerrainTileIndex::tilesNear(const MapPoint &centre,
+                                                    double radius) const {
+  auto tiles = Tiles{};
+  if (_tilesByChunk.empty()) return tiles;
+
+  // The tiles that could overlap the circle's bounding box.  Alternate rows
+  // are offset by half a tile, so allow an extra column either side.
+  auto toColumn = [&](double x) {
+    auto column = static_cast<long long>(x / Map::TILE_W);
+    return static_cast<size_t>(
+        max(0LL, min(column, static_cast<long long>(_map.width()) - 1)));
+  };
+  const auto firstColumn = toColumn(centre.x - radius - Map::TILE_W),
+             lastColumn = toColumn(centre.x + radius + Map::TILE_W);
+  const auto firstRow = _map.getRow(centre.y - radius),
+             lastRow = _map.getRow(centre.y + radius);
+
+  const auto centreRect = MapRect{centre};
+  for (auto chunkY = firstRow / CHUNK_SIZE; chunkY <= lastRow / CHUNK_SIZE;
+       ++chunkY)
+    for (auto chunkX = firstColumn / CHUNK_SIZE;
+         chunkX <= lastColumn / CHUNK_SIZE; ++chunkX)
+      for (auto tile : _tilesByChunk[chunkY * _chunksWide + chunkX]) {
+        auto coords = _map.from1D(tile);
+        auto tileRect = Map::getTileRect(coords.first, coords.second);
+        if (distance(tileRect, centreRect) > radius) continue;
+        tiles.push_back(tile);
+      }
+
+  std::sort(tiles.begin(), tiles.end());
+  return tiles;
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <vector>
+
+#include "../Point.h"
+
+class Map;
+class TerrainList;
+
+// Every map tile that a terrain list allows, grouped by square chunks of the
+// map, so that the allowed tiles near a point can be found without scanning
+// the whole map.  The server builds one per terrain list, when first needed.
+class TerrainTileIndex {
+ public:
+  TerrainTileIndex(const Map &map, const TerrainList &terrainList);
+
+  using Tiles = std::vector<size_t>;  // As numbered by Map::to1D()
+  // Allowed tiles within the radius of the point, in row-major order
+  Tiles tilesNear(const MapPoint &centre, double radius) const;
+
+ private:
+  static const size_t CHUNK_SIZE = 16;  // In tiles
+  const Map &_map;
+  size_t _chunksWide{0}, _chunksHigh{0};
+  std::vector<Tiles> _tilesByChunk;  // Row-major
+};
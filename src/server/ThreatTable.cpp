@@ -4,7 +4,9 @@
 
 void ThreatTable::makeAwareOf(Entity& entity) {
   auto it = _container.find(&entity);
-  if (it == _container.end()) _container[&entity] = 0;
+  if (it != _container.end()) return;
+  _container[&entity] = 0;
+  References::add(_owner, entity);
 }
 
 bool ThreatTable::isAwareOf(Entity& entity) const {
@@ -17,13 +19,15 @@ void ThreatTable::forgetAbout(const Entity& entity) {
   auto it = _container.find(&nonConstRef);
   if (it == _container.end()) return;
   _container.erase(it);
+  References::remove(_owner, entity);
 }
 
 void ThreatTable::addThreat(Entity& entity, Threat amount) {
   auto it = _container.find(&entity);
-  if (it == _container.end())
+  if (it == _container.end()) {
     _container[&entity] = amount;
-  else
+    References::add(_owner, entity);
+  } else
     it->second += amount;
 }
 
@@ -51,7 +55,10 @@ Entity* ThreatTable::getTarget() {
   return target;
 }
 
-void ThreatTable::clear() { _container.clear(); }
+void ThreatTable::clear() {
+  for (auto pair : _container) References::remove(_owner, *pair.first);
+  _container.clear();
+}
 
 bool ThreatTable::isEmpty() const { return _container.empty(); }
 
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <string>
+#include <unordered_map>
+
+// A hash index from ID to an entry in one of the server's type registries.
+// It is emptied before data is loaded and rebuilt afterwards, so that it never
+// points at a replaced entry; until it is built, callers should search the
+// registry itself.
+template <typename T>
+class TypeIndex {
+ public:
+  bool isBuilt() const { return _isBuilt; }
+  void markAsBuilt() { _isBuilt = true; }
+  void clear() {
+    _entries.clear();
+    _isBuilt = false;
+  }
+
+  // Keeps the first entry added for an ID, as a front-to-back search would.
+  void add(const std::string &id, T *entry) { _entries.emplace(id, entry); }
+
+  T *find(const std::string &id) const {
+    auto it = _entries.find(id);
+    if (it == _entries.end()) return nullptr;
+    return it->second;
+  }
+
+ private:
+  std::unordered_map<std::string, T *> _entries;
+  bool _isBuilt{false};
+};
@@ -51,6 +51,7 @@ User::User(const std::string &name, const MapPoint &loc, const Socket *socket)
       _inventory(INVENTORY_SIZE),
       _gear(GEAR_SLOTS),
       _lastContact(SDL_GetTicks()) {
+  classTag('u');
   if (socket) _socket = *socket;
 
   // Once-off init
@@ -60,10 +61,14 @@ User::User(const std::string &name, const MapPoint &loc, const Socket *socket)
 }
 
 User::User(const Socket &rhs)
-    : Object(MapPoint{}), _socket(rhs), exploration(0, 0) {}
+    : Object(MapPoint{}), _socket(rhs), exploration(0, 0) {
+  classTag('u');
+}
 
 User::User(const MapPoint &loc)
-    : Object(loc), _socket(Socket::Empty()), exploration(0, 0) {}
+    : Object(loc), _socket(Socket::Empty()), exploration(0, 0) {
+  classTag('u');
+}
 
 void User::initialiseInventoryAndGear() {
   for (size_t i = 0; i != INVENTORY_SIZE; ++i) {
@@ -261,6 +266,7 @@ bool User::hasExceededTimeout() const {
 
 size_t User::giveItem(const ServerItem *item, size_t quantity) {
   auto &server = Server::instance();
+  markAsChanged();
 
   auto remaining = quantity;
 
@@ -400,9 +406,16 @@ void User::finishAction() {
   _action = NO_ACTION;
 }
 
+void User::actionObject(Entity *ent) {
+  if (ent == _actionObject) return;
+  if (_actionObject) References::remove(*this, *_actionObject);
+  _actionObject = ent;
+  if (_actionObject) References::add(*this, *_actionObject);
+}
+
 void User::beginGathering(Entity *ent, double speedMultiplier) {
   _action = GATHER;
-  _actionObject = ent;
+  actionObject(ent);
   _actionObject->gatherable.incrementGatheringUsers();
   if (!ent->type()) {
     SERVER_ERROR("Can't gather from object with no type");
@@ -438,7 +451,7 @@ void User::beginConstructing(const ObjectType &obj, const MapPoint &location,
 
 void User::beginDeconstructing(Object &obj) {
   _action = DECONSTRUCT;
-  _actionObject = &obj;
+  actionObject(&obj);
   _actionTime = obj.deconstruction().timeToDeconstruct();
 }
 
@@ -579,7 +592,8 @@ User::ToolSearchResult User::findTool(const std::string &tagName) {
   // Note that checking collision chunks means ignoring non-colliding objects.
   auto nearbyEntities = server.findEntitiesInArea(location());
   for (auto *pEnt : nearbyEntities) {
-    auto *pObj = dynamic_cast<Object *>(pEnt);
+    if (!pEnt->hasCapability(HAS_TAGS)) continue;
+    auto *pObj = pEnt->as<Object>();
     if (!pObj) continue;
     if (pObj->isBeingBuilt()) continue;
     const auto *type = pObj->type();
@@ -939,6 +953,7 @@ void User::onMove() {
   for (const auto &chunk : newlyExploredChunks)
     exploration.sendSingleChunk(socket(), chunk);
   if (!newlyExploredChunks.empty()) {
+    server._publishedStats.userProgressed(*this);
     auto of = std::ofstream{"exploration.log", std::ios_base::app};
     of << _name                                   // Player name
        << "," << exploration.numChunksExplored()  // Chunks explored
@@ -949,7 +964,8 @@ void User::onMove() {
   // Get buffs from objects
   auto buffsToAdd = std::map<const BuffType *, Entity *>{};
   for (auto *entity : server.findEntitiesInArea(location())) {
-    const Object *pObj = dynamic_cast<const Object *>(entity);
+    if (!entity->hasCapability(GRANTS_BUFF)) continue;
+    const Object *pObj = entity->as<Object>();
     if (pObj == nullptr) continue;
     if (!pObj->permissions.doesUserHaveAccess(_name)) continue;
     if (pObj->isBeingBuilt()) continue;
@@ -1430,6 +1446,8 @@ void User::addRecipe(const std::string &id, bool newlyLearned) {
   _knownRecipes.insert(id);
 
   if (!newlyLearned) return;
+  Server::instance()._publishedStats.userProgressed(*this);
+
   auto of = std::ofstream{"recipes.log", std::ios_base::app};
   of << _name                        // Player name
      << "," << _knownRecipes.size()  // Recipes known
@@ -1451,6 +1469,8 @@ void User::addConstruction(const std::string &id, bool newlyLearned) {
   _knownConstructions.insert(id);
 
   if (!newlyLearned) return;
+  Server::instance()._publishedStats.userProgressed(*this);
+
   auto of = std::ofstream{"constructions.log", std::ios_base::app};
   of << _name                              // Player name
      << "," << _knownConstructions.size()  // Constructions known
@@ -1627,8 +1647,8 @@ std::set<NPC *> User::findNearbyPets() {
   Server &server = Server::instance();
   for (auto *entity :
        server.findEntitiesInArea(location(), PET_DEFEND_MASTER_RADIUS)) {
-    if (entity->classTag() != 'n') continue;
-    auto *npc = dynamic_cast<NPC *>(entity);
+    auto *npc = entity->as<NPC>();
+    if (!npc) continue;
     if (!npc->permissions.isOwnedByPlayer(_name)) continue;
 
     ret.insert(npc);
@@ -1695,6 +1715,7 @@ void User::completeQuest(const Quest::ID &id) {
   }
 
   sendMessage({SV_QUEST_COMPLETED, id});
+  server._publishedStats.userProgressed(*this);
 }
 
 void User::giveQuestReward(const Quest::Reward &reward) {
@@ -1863,6 +1884,7 @@ int User::getGroupSize() const {
 void User::addXP(XP amount) {
   if (_level == MAX_LEVEL) return;
   _xp += amount;
+  markAsChanged();
 
   Server &server = Server::instance();
   sendMessage({SV_XP_GAIN, amount});
@@ -1887,6 +1909,7 @@ void User::levelUp() {
   ++_level;
   fillHealthAndEnergy();
   announceLevelUp();
+  Server::instance()._publishedStats.userProgressed(*this);
 
   auto of = std::ofstream{"levels.log", std::ios_base::app};
   of << _name                              // Player name
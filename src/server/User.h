@@ -139,7 +139,7 @@ class User : public Object {  // TODO: Don't inherit from Object
   };
   int secondsPlayedThisSession() const;
   int secondsPlayed() const;
-  mutable int secondsOffline{0};  // Used only for logging; 0 for online players
+  mutable time_t timeLastOnline{0};  // Used only for logging; 0 while online
   void sendTimePlayed() const;
   Message teleportMessage(const MapPoint &destination) const override;
   void onTeleport() override;
@@ -224,7 +224,7 @@ class User : public Object {  // TODO: Don't inherit from Object
   bool isInCombat() const { return _isInCombat; }
   void putInCombat() { _isInCombat = true; }
 
-  char classTag() const override { return 'u'; }
+  static bool hasClassTag(char tag) { return tag == 'u'; }
   void loadBuff(const BuffType &type, ms_t timeRemaining) override;
   void loadDebuff(const BuffType &type, ms_t timeRemaining) override;
   void sendBuffMsg(const Buff::ID &buff) const override;
@@ -266,6 +266,7 @@ class User : public Object {  // TODO: Don't inherit from Object
   Action action() const { return _action; }
   void action(Action a) { _action = a; }
   const Entity *actionObject() const { return _actionObject; }
+  void actionObject(Entity *ent);
   void beginGathering(Entity *ent,
                       double speedMultiplier);  // Configure user to perform an
                                                 // action on an object
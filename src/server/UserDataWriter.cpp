@@ -0,0 +1,99 @@
+#include "UserDataWriter.h"
+
+#include <SDL.h>
+
+#include <fstream>
+
+#include "../threadNaming.h"
+
+UserDataWriter::UserDataWriter(AccountStore &store) : _store(store) {
+#ifndef SINGLE_THREAD
+  _thread = std::thread{[this]() {
+    setThreadName("Writing user data");
+    run();
+  }};
+#endif
+}
+
+UserDataWriter::~UserDataWriter() {
+#ifndef SINGLE_THREAD
+  {
+    auto lock = std::unique_lock<std::mutex>{_mutex};
+    _shouldStop = true;
+  }
+  _stateChanged.notify_all();
+  _thread.join();
+#endif
+}
+
+void UserDataWriter::write(const std::string &name, std::string contents) {
+#ifdef SINGLE_THREAD
+  writeBatch({{name, std::move(contents)}}, 0);
+#else
+  {
+    auto lock = std::unique_lock<std::mutex>{_mutex};
+    auto &queued = _pending[name];
+    if (!queued.empty()) ++_numSuperseded;
+    queued = std::move(contents);
+  }
+  _stateChanged.notify_all();
+#endif
+}
+
+void UserDataWriter::waitUntilWritten(const std::string &name) {
+#ifndef SINGLE_THREAD
+  auto lock = std::unique_lock<std::mutex>{_mutex};
+  _stateChanged.wait(lock, [&]() {
+    return _pending.count(name) == 0 && _beingWritten.count(name) == 0;
+  });
+#endif
+}
+
+void UserDataWriter::waitUntilIdle() {
+#ifndef SINGLE_THREAD
+  auto lock = std::unique_lock<std::mutex>{_mutex};
+  _stateChanged.wait(
+      lock, [this]() { return _pending.empty() && _beingWritten.empty(); });
+#endif
+}
+
+#ifndef SINGLE_THREAD
+void UserDataWriter::run() {
+  auto lock = std::unique_lock<std::mutex>{_mutex};
+  while (true) {
+    _stateChanged.wait(lock,
+                       [this]() { return !_pending.empty() || _shouldStop; });
+    if (_pending.empty()) return;  // Stopping, and everything has been written.
+
+    auto batch = Batch{};
+    batch.swap(_pending);
+    auto numSuperseded = _numSuperseded;
+    _numSuperseded = 0;
+    for (const auto &file : batch) _beingWritten.insert(file.first);
+
+    lock.unlock();
+    writeBatch(batch, numSuperseded);
+    lock.lock();
+
+    _beingWritten.clear();
+    _stateChanged.notify_all();
+  }
+}
+#endif
+
+void UserDataWriter::writeBatch(const Batch &batch, int numSuperseded) {
+  const auto startTime = SDL_GetTicks();
+
+  auto accounts = AccountStore::Accounts{};
+  accounts.reserve(batch.size());
+  for (const auto &pair : batch) accounts.push_back({pair.first, pair.second});
+  const auto numWritten = _store.write(accounts) ? accounts.size() : 0;
+
+  const auto writeTime = SDL_GetTicks() - startTime;
+  auto of = std::ofstream{"userSaving.log", std::ios_base::app};
+  of << batch.size()          // Users in the batch
+     << "," << numWritten     // Of those, users written
+     << "," << writeTime      // Time to append and flush them (ms)
+     << "," << numSuperseded  // Queued versions replaced by newer ones
+     << std::endl;
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <map>
+#include <set>
+#include <string>
+
+#include "AccountStore.h"
+
+#ifndef SINGLE_THREAD
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#endif
+
+// Writes users' data to the account store on a single background thread.
+// Data is encoded on the game thread and queued here by user name; a newer
+// version replaces any version still waiting.  Everything waiting is written to
+// the store together, with a single flush to the disk.
+class UserDataWriter {
+ public:
+  UserDataWriter(AccountStore &store);
+  ~UserDataWriter();  // Finishes writing anything already queued.
+
+  void write(const std::string &name, std::string contents);
+  void waitUntilWritten(const std::string &name);  // Before reading the data
+  void waitUntilIdle();
+
+ private:
+  using Batch = std::map<std::string, std::string>;  // Name -> contents
+  void writeBatch(const Batch &batch, int numSuperseded);
+
+  AccountStore &_store;
+
+#ifndef SINGLE_THREAD
+  void run();
+
+  std::mutex _mutex;
+  std::condition_variable _stateChanged;
+  Batch _pending;
+  int _numSuperseded{0};  // Queued versions replaced by newer ones
+  std::set<std::string> _beingWritten;
+  bool _shouldStop{false};
+  std::thread _thread;
+#endif
+};
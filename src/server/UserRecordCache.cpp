@@ -0,0 +1,33 @@
+#include "UserRecordCache.h"
+
+UserRecordCache::Record UserRecordCache::find(const std::string &name) {
+  auto it = _entriesByName.find(name);
+  if (it == _entriesByName.end()) return {};
+
+  _entries.splice(_entries.begin(), _entries, it->second);
+  auto &entry = *it->second;
+  if (!entry.parsed) {
+    entry.parsed = std::make_shared<XmlReader>();
+    entry.parsed->newString(entry.contents);
+    entry.contents = {};
+  }
+  return entry.parsed;
+}
+
+void UserRecordCache::add(const std::string &name, std::string contents) {
+  auto it = _entriesByName.find(name);
+  if (it != _entriesByName.end()) {
+    it->second->contents = std::move(contents);
+    it->second->parsed.reset();
+    _entries.splice(_entries.begin(), _entries, it->second);
+    return;
+  }
+
+  _entries.push_front({name, std::move(contents), {}});
+  _entriesByName[name] = _entries.begin();
+
+  if (_entries.size() > _capacity) {
+    _entriesByName.erase(_entries.back().name);
+    _entries.pop_back();
+  }
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include "../XmlReader.h"
+
+// User data for the users most recently saved or read, so that a login parses
+// each user's data at most once, and a reconnecting user's data needn't be
+// read back from the store.  Records are parsed when first needed.  Once full,
+// the least recently used record is dropped.
+class UserRecordCache {
+ public:
+  using Record = std::shared_ptr<XmlReader>;
+
+  UserRecordCache(size_t capacity) : _capacity(capacity) {}
+
+  Record find(const std::string &name);  // Null if not cached
+  void add(const std::string &name, std::string contents);
+
+ private:
+  size_t _capacity;
+  struct Entry {
+    std::string name;
+    std::string contents;  // Emptied once parsed
+    Record parsed;
+  };
+  std::list<Entry> _entries;  // Most recently used first
+  std::unordered_map<std::string, std::list<Entry>::iterator> _entriesByName;
+};
@@ -4,7 +4,22 @@
 #include "VehicleType.h"
 
 Vehicle::Vehicle(const VehicleType *type, const MapPoint &loc)
-    : Object(type, loc) {}
+    : Object(type, loc) {
+  classTag('v');
+}
+
+Vehicle::~Vehicle() {
+  if (_driver.empty()) return;
+  Server::_instance->_entities.deregisterDriver(*this);
+}
+
+void Vehicle::driver(const std::string &username) {
+  auto &entities = Server::_instance->_entities;
+  entities.deregisterDriver(*this);
+  _driver = username;
+  entities.registerDriver(*this);
+  markAsChanged();
+}
 
 bool Vehicle::shouldMoveWhereverRequested() const {
   auto isDriving = !_driver.empty();
@@ -18,7 +33,7 @@ void Vehicle::onDeath() {
     pDriver->sendMessage({SV_VEHICLE_WAS_UNMOUNTED, makeArgs(serial(), _driver)});
   }
 
-  _driver.clear();
+  driver({});
 
   Object::onDeath();
 }
@@ -10,14 +10,14 @@ class Vehicle : public Object {
 
  public:
   Vehicle(const VehicleType *type, const MapPoint &loc);
-  virtual ~Vehicle() {}
+  virtual ~Vehicle();
 
   const std::string &driver() const { return _driver; }
-  void driver(const std::string &username) { _driver = username; }
+  void driver(const std::string &username);
   bool shouldMoveWhereverRequested() const override;
   void onDeath() override;
 
-  char classTag() const override { return 'v'; }
+  static bool hasClassTag(char tag) { return tag == 'v'; }
 };
 
 #endif
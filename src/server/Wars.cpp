@@ -1,7 +1,7 @@
 #include "Wars.h"
 
 #include "../XmlReader.h"
-#include "../XmlWriter.h"
+#include "../XmlStreamWriter.h"
 #include "Server.h"
 
 bool Belligerent::operator<(const Belligerent &rhs) const {
@@ -182,21 +182,21 @@ bool Wars::cancelPeaceOffer(const Belligerent &proposer,
   return true;
 }
 
-void Wars::writeToXMLFile(const std::string &filename) const {
-  XmlWriter xw(filename);
+void Wars::writeToXML(XmlStreamWriter &xw) const {
   for (const auto &war : container) {
-    auto e = xw.addChild("war");
+    xw.openElement("war");
 
-    xw.setAttr(e, "name1", war.b1.name);
-    if (war.b1.type == Belligerent::CITY) xw.setAttr(e, "isCity1", 1);
-    xw.setAttr(e, "name2", war.b2.name);
-    if (war.b2.type == Belligerent::CITY) xw.setAttr(e, "isCity2", 1);
+    xw.setAttr("name1", war.b1.name);
+    if (war.b1.type == Belligerent::CITY) xw.setAttr("isCity1", 1);
+    xw.setAttr("name2", war.b2.name);
+    if (war.b2.type == Belligerent::CITY) xw.setAttr("isCity2", 1);
 
     if (war.peaceState != War::NO_PEACE_PROPOSED) {
-      xw.setAttr(e, "peaceProposedBy", war.peaceState);
+      xw.setAttr("peaceProposedBy", static_cast<int>(war.peaceState));
     }
+
+    xw.closeElement();
   }
-  xw.publish();
 }
 
 void Wars::readFromXMLFile(const std::string &filename) {
@@ -8,6 +8,8 @@
 
 #include "User.h"
 
+class XmlStreamWriter;
+
 struct Belligerent {
   enum Type { CITY, PLAYER };
 
@@ -62,7 +64,7 @@ class Wars {
   // Return value: whether there was a peace offer that was successfully revoked
   bool cancelPeaceOffer(const Belligerent &proposer, const Belligerent &enemy);
 
-  void writeToXMLFile(const std::string &filename) const;
+  void writeToXML(XmlStreamWriter &xw) const;
   void readFromXMLFile(const std::string &filename);
 
   static void changePlayerBelligerentToHisCity(Belligerent &belligerent);
@@ -0,0 +1,155 @@
+#include "WorldSaver.h"
+
+#include <SDL.h>
+
+#include <algorithm>
+#include <fstream>
+
+#include "../parallel.h"
+#include "../threadNaming.h"
+#include "FileTransaction.h"
+
+WorldSaver::WorldSaver() {
+#ifndef SINGLE_THREAD
+  _thread = std::thread{[this]() {
+    setThreadName("Saving world");
+    run();
+  }};
+#endif
+}
+
+WorldSaver::~WorldSaver() {
+#ifndef SINGLE_THREAD
+  {
+    auto lock = std::unique_lock<std::mutex>{_mutex};
+    _shouldStop = true;
+  }
+  _stateChanged.notify_all();
+  _thread.join();
+#endif
+}
+
+void WorldSaver::save(std::unique_ptr<Snapshot> snapshot) {
+#ifdef SINGLE_THREAD
+  noteResult(*snapshot, write(*snapshot, 0));
+#else
+  {
+    auto lock = std::unique_lock<std::mutex>{_mutex};
+    if (_pending) {
+      _pending->absorb(*snapshot);
+      ++_numMerged;
+    } else
+      _pending = std::move(snapshot);
+  }
+  _stateChanged.notify_all();
+#endif
+}
+
+void WorldSaver::waitUntilIdle() {
+#ifndef SINGLE_THREAD
+  auto lock = std::unique_lock<std::mutex>{_mutex};
+  _stateChanged.wait(lock, [this]() { return !_pending && !_isWriting; });
+#endif
+}
+
+#ifndef SINGLE_THREAD
+void WorldSaver::run() {
+  auto lock = std::unique_lock<std::mutex>{_mutex};
+  while (true) {
+    _stateChanged.wait(lock, [this]() { return _pending || _shouldStop; });
+    if (!_pending) return;  // Stopping, and everything has been written.
+
+    auto snapshot = std::move(_pending);
+    auto numMerged = _numMerged;
+    _numMerged = 0;
+    _isWriting = true;
+
+    lock.unlock();
+    noteResult(*snapshot, write(*snapshot, numMerged));
+    snapshot.reset();
+    lock.lock();
+
+    _isWriting = false;
+    _stateChanged.notify_all();
+  }
+}
+#endif
+
+void WorldSaver::noteResult(const Snapshot &snapshot, bool succeeded) {
+  if (!succeeded)
+    _needsCompleteSnapshot = true;
+  else if (snapshot.isComplete)
+    _needsCompleteSnapshot = false;
+}
+
+bool WorldSaver::write(Snapshot &snapshot, int numMerged) {
+  const auto startTime = SDL_GetTicks();
+
+  // Everything is synced to disk together, once.
+  FileTransaction transaction;
+  parallelFor(
+      snapshot.files.size(),
+      [&](size_t i) {
+        const auto &file = *snapshot.files[i];
+        transaction.replace(file.filename(), file.contents());
+      },
+      "World saver");
+  auto numShards = size_t{0};
+  for (auto &file : snapshot.shardedFiles) {
+    file->publish(transaction);
+    numShards += file->shards().size();
+  }
+  for (const auto &log : snapshot.logsToClear) transaction.replace(log, {});
+  for (auto &entries : snapshot.logEntries)
+    transaction.append(entries->filename(), entries->contents());
+  const auto succeeded = transaction.commit();
+
+  const auto writeTime = SDL_GetTicks() - startTime;
+  const auto numFiles = snapshot.files.size() + numShards;
+
+  auto of = std::ofstream{"saving.log", std::ios_base::app};
+  of << snapshot.pauseTime  // Game-thread pause to take the snapshot (ms)
+     << "," << writeTime    // Time to write it (ms)
+     << "," << numMerged    // Later snapshots merged into it
+     << "," << numFiles     // Files rewritten in full
+     << "," << snapshot.logEntries.size()  // Batches of log entries appended
+     << std::endl;
+
+  return succeeded;
+}
+
+// Add the file, replacing any earlier version of it.
+template <typename File>
+static void replaceFile(std::vector<std::unique_ptr<File>> &files,
+                        std::unique_ptr<File> &file) {
+  const auto &filename = file->filename();
+  files.erase(std::remove_if(files.begin(), files.end(),
+                             [&](const std::unique_ptr<File> &f) {
+                               return f->filename() == filename;
+                             }),
+              files.end());
+  files.push_back(std::move(file));
+}
+
+void WorldSaver::Snapshot::absorb(Snapshot &later) {
+  for (auto &file : later.files) replaceFile(files, file);
+  for (auto &file : later.shardedFiles) replaceFile(shardedFiles, file);
+
+  for (const auto &log : later.logsToClear) {
+    // Entries destined for a cleared log would be wiped anyway.
+    logEntries.erase(std::remove_if(logEntries.begin(), logEntries.end(),
+                                    [&](const TextFile &e) {
+                                      return e->filename() == log;
+                                    }),
+                     logEntries.end());
+    if (std::find(logsToClear.begin(), logsToClear.end(), log) ==
+        logsToClear.end())
+      logsToClear.push_back(log);
+  }
+
+  for (auto &entries : later.logEntries)
+    logEntries.push_back(std::move(entries));
+
+  pauseTime += later.pauseTime;
+  isComplete = isComplete || later.isComplete;
+}
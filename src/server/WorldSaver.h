@@ -0,0 +1,66 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+#ifndef SINGLE_THREAD
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#endif
+
+#include "../XmlStreamWriter.h"
+#include "../types.h"
+#include "ShardedWorldFile.h"
+
+// Writes snapshots of the world to disk on a single background thread.  Each
+// snapshot is built on the game thread between ticks, so the writer never
+// touches live game state.  A snapshot still waiting when a newer one arrives
+// is merged with it, so that at most one write is ever queued.
+//
+// A write that fails may lose changes the game thread already counts as
+// saved.  From then until a complete snapshot is written successfully, the
+// saver reports that one is needed.
+class WorldSaver {
+ public:
+  struct Snapshot {
+    using TextFile = std::unique_ptr<XmlStreamWriter>;
+    std::vector<TextFile> files;  // Replaced whole
+    std::vector<std::unique_ptr<ShardedWorldFile>> shardedFiles;  // Likewise
+    std::vector<std::string> logsToClear;  // Made redundant by the files
+    std::vector<TextFile> logEntries;      // Appended last
+    ms_t pauseTime{0};  // Time the game thread spent building it
+    bool isComplete{false};  // Holds every entity, not just changes
+
+    // Fold in a later snapshot, so that writing this one has the effect of
+    // writing both in order.
+    void absorb(Snapshot &later);
+  };
+
+  WorldSaver();
+  ~WorldSaver();  // Finishes writing anything already queued.
+
+  void save(std::unique_ptr<Snapshot> snapshot);
+  void waitUntilIdle();
+  bool needsCompleteSnapshot() const { return _needsCompleteSnapshot; }
+
+ private:
+  static bool write(Snapshot &snapshot, int numMerged);  // False on failure
+  void noteResult(const Snapshot &snapshot, bool succeeded);
+
+  std::atomic<bool> _needsCompleteSnapshot{false};
+
+#ifndef SINGLE_THREAD
+  void run();
+
+  std::mutex _mutex;
+  std::condition_variable _stateChanged;
+  std::unique_ptr<Snapshot> _pending;
+  int _numMerged{0};  // Later snapshots absorbed into _pending
+  bool _isWriting{false};
+  bool _shouldStop{false};
+  std::thread _thread;
+#endif
+};
@@ -0,0 +1,9 @@
+#include "checksum.h"
+
+uint32_t checksum(const char *data, size_t length, uint32_t hash) {
+  for (auto i = size_t{0}; i != length; ++i) {
+    hash ^= static_cast<unsigned char>(data[i]);
+    hash *= 16777619u;
+  }
+  return hash;
+}
@@ -0,0 +1,9 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// FNV-1a.  Pass a previous result as the starting hash to continue it over
+// more data.
+uint32_t checksum(const char *data, size_t length,
+                  uint32_t hash = 2166136261u);
@@ -65,7 +65,7 @@ std::pair<size_t, size_t> Server::getTileCoords(const MapPoint &p) const {
 
 char Server::findTile(const MapPoint &p) const {
   auto coords = getTileCoords(p);
-  return _map[coords.first][coords.second];
+  return _map.at(coords.first, coords.second);
 }
 
 CollisionChunk &Server::getCollisionChunk(const MapPoint &p) {
@@ -121,34 +121,26 @@ bool Entity::areOverlapsAllowedWith(const Entity &rhs) const { return false; }
 bool User::areOverlapsAllowedWith(const Entity &rhs) const {
   if (rhs.classTag() == 'u' || rhs.classTag() == 'n') return true;
 
-  if (rhs.classTag() == 'o') {
-    const auto &obj = dynamic_cast<const Object &>(rhs);
-    if (obj.isGate()) return obj.permissions.doesUserHaveAccess(_name);
-  }
+  if (rhs.classTag() == 'o' && rhs.hasCapability(IS_GATE))
+    return rhs.permissions.doesUserHaveAccess(_name);
   return false;
 }
 
 bool NPC::areOverlapsAllowedWith(const Entity &rhs) const {
   if (rhs.classTag() == 'u') return true;
 
-  if (rhs.classTag() == 'o') {
-    const auto &obj = dynamic_cast<const Object &>(rhs);
-    if (obj.isGate()) return obj.permissions.doesNPCHaveAccess(*this);
-  }
+  if (rhs.classTag() == 'o' && rhs.hasCapability(IS_GATE))
+    return rhs.permissions.doesNPCHaveAccess(*this);
 
   return false;
 }
 
 bool Object::areOverlapsAllowedWith(const Entity &rhs) const {
-  if (!isGate()) return false;
-  if (rhs.classTag() == 'u') {
-    const auto &user = dynamic_cast<const User &>(rhs);
-    return permissions.doesUserHaveAccess(user.name());
-  }
-  if (rhs.classTag() == 'n') {
-    const auto &npc = dynamic_cast<const NPC &>(rhs);
-    return permissions.doesNPCHaveAccess(npc);
-  }
+  if (!hasCapability(IS_GATE)) return false;
+  if (const auto *user = rhs.as<User>())
+    return permissions.doesUserHaveAccess(user->name());
+  if (const auto *npc = rhs.as<NPC>())
+    return permissions.doesNPCHaveAccess(*npc);
   return false;
 }
 
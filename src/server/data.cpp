@@ -1,20 +1,32 @@
-#ifndef SINGLE_THREAD
-#include <mutex>
-#include <thread>
-#endif
+#include <fstream>
 
 #include "../XmlReader.h"
-#include "../XmlWriter.h"
+#include "../XmlStreamWriter.h"
+#include "BinaryWorldFile.h"
 #include "DataLoader.h"
 #include "DroppedItem.h"
+#include "SavedEntity.h"
 #include "Server.h"
+#include "ShardedWorldFile.h"
 #include "Vehicle.h"
 
 extern Args cmdLineArgs;
 
+UserRecordCache::Record Server::findUserRecord(const std::string &name) const {
+  auto record = _userRecords.find(name);
+  if (record) return record;
+
+  _userDataWriter.waitUntilWritten(name);
+  auto contents = ""s;
+  if (!_accounts.read(name, contents)) return {};
+  _userRecords.add(name, std::move(contents));
+  return _userRecords.find(name);
+}
+
 bool Server::readUserData(User &user, bool allowSideEffects) {
-  auto xr = XmlReader::FromFile(_userFilesPath + user.name() + ".usr");
-  if (!xr) return false;
+  auto record = findUserRecord(user.name());
+  if (!record) return false;
+  auto &xr = *record;
 
   auto timeSinceThisDataWasWritten = ms_t{0};
   {
@@ -35,12 +47,13 @@ bool Server::readUserData(User &user, bool allowSideEffects) {
 
     auto classID = ClassType::ID{};
     if (!xr.findAttr(elem, "class", classID)) return false;
-    auto it = _classes.find(classID);
-    if (it == _classes.end()) {
+    const auto *classType = findClass(classID);
+    if (!classType) {
       _debug << Color::CHAT_ERROR << "Invalid class (" << classID
              << ") specified; creating new character." << Log::endl;
+      return false;
     }
-    user.setClass(it->second);
+    user.setClass(*classType);
 
     auto level = Level{0};
     if (xr.findAttr(elem, "level", level)) user.level(level);
@@ -259,138 +272,166 @@ bool Server::readUserData(User &user, bool allowSideEffects) {
 void Server::writeUserData(const User &user) const {
   incrementThreadCount();
 
-  XmlWriter xw(_userFilesPath + user.name() + ".usr");
-
-  auto e = xw.addChild("general");
-  xw.setAttr(e, "passwordHash", user.pwHash());
-  xw.setAttr(e, "timeThisWasWritten", time(nullptr));
-  xw.setAttr(e, "secondsPlayed", user.secondsPlayed());
-  xw.setAttr(e, "ip", user.socket().ip());
-  xw.setAttr(e, "realWorldLocation", user.realWorldLocation());
-  xw.setAttr(e, "class", user.getClass().type().id());
-  if (_kings.isPlayerAKing(user.name())) xw.setAttr(e, "isKing", 1);
-  if (user.isInTutorial()) xw.setAttr(e, "isInTutorial", 1);
-  xw.setAttr(e, "level", user.level());
-  xw.setAttr(e, "xp", user.xp());
-  if (user.isDriving()) xw.setAttr(e, "isDriving", 1);
-
-  if (user.isMissingHealth()) xw.setAttr(e, "health", user.health());
+  auto xw = XmlStreamWriter::Document(user.name());
+
+  xw.openElement("general");
+  xw.setAttr("passwordHash", user.pwHash());
+  xw.setAttr("timeThisWasWritten", time(nullptr));
+  xw.setAttr("secondsPlayed", user.secondsPlayed());
+  xw.setAttr("ip", user.socket().ip());
+  xw.setAttr("realWorldLocation", user.realWorldLocation());
+  xw.setAttr("class", user.getClass().type().id());
+  if (_kings.isPlayerAKing(user.name())) xw.setAttr("isKing", 1);
+  if (user.isInTutorial()) xw.setAttr("isInTutorial", 1);
+  xw.setAttr("level", user.level());
+  xw.setAttr("xp", user.xp());
+  if (user.isDriving()) xw.setAttr("isDriving", 1);
+
+  if (user.isMissingHealth()) xw.setAttr("health", user.health());
   if (user.energy() < user.stats().maxEnergy)
-    xw.setAttr(e, "energy", user.energy());
+    xw.setAttr("energy", user.energy());
+  xw.closeElement();
 
-  e = xw.addChild("location");
-  xw.setAttr(e, "x", user.location().x);
-  xw.setAttr(e, "y", user.location().y);
+  xw.openElement("location");
+  xw.setAttr("x", user.location().x);
+  xw.setAttr("y", user.location().y);
+  xw.closeElement();
 
-  e = xw.addChild("respawnPoint");
-  xw.setAttr(e, "x", user.respawnPoint().x);
-  xw.setAttr(e, "y", user.respawnPoint().y);
+  xw.openElement("respawnPoint");
+  xw.setAttr("x", user.respawnPoint().x);
+  xw.setAttr("y", user.respawnPoint().y);
+  xw.closeElement();
 
-  e = xw.addChild("inventory");
+  xw.openElement("inventory");
   for (size_t i = 0; i != User::INVENTORY_SIZE; ++i) {
     const auto &slot = user.inventory(i);
     if (slot.first.hasItem()) {
-      auto slotElement = xw.addChild("slot", e);
-      xw.setAttr(slotElement, "slot", i);
-      xw.setAttr(slotElement, "id", slot.first.type()->id());
-      xw.setAttr(slotElement, "health", slot.first.health());
-      if (slot.second > 1) xw.setAttr(slotElement, "quantity", slot.second);
-      if (slot.first.isSoulbound()) xw.setAttr(slotElement, "soulbound", 1);
+      xw.openElement("slot");
+      xw.setAttr("slot", i);
+      xw.setAttr("id", slot.first.type()->id());
+      xw.setAttr("health", slot.first.health());
+      if (slot.second > 1) xw.setAttr("quantity", slot.second);
+      if (slot.first.isSoulbound()) xw.setAttr("soulbound", 1);
+      xw.closeElement();
     }
   }
+  xw.closeElement();
 
-  e = xw.addChild("gear");
+  xw.openElement("gear");
   for (size_t i = 0; i != User::GEAR_SLOTS; ++i) {
     const auto &slot = user.gear(i);
     if (slot.first.hasItem()) {
-      auto slotElement = xw.addChild("slot", e);
-      xw.setAttr(slotElement, "slot", i);
-      xw.setAttr(slotElement, "id", slot.first.type()->id());
-      xw.setAttr(slotElement, "health", slot.first.health());
-      if (slot.second > 1) xw.setAttr(slotElement, "quantity", slot.second);
+      xw.openElement("slot");
+      xw.setAttr("slot", i);
+      xw.setAttr("id", slot.first.type()->id());
+      xw.setAttr("health", slot.first.health());
+      if (slot.second > 1) xw.setAttr("quantity", slot.second);
+      xw.closeElement();
     }
   }
+  xw.closeElement();
 
-  e = xw.addChild("buffs");
+  xw.openElement("buffs");
   for (const auto &buff : user.buffs()) {
-    auto buffElement = xw.addChild("buff", e);
-    xw.setAttr(buffElement, "type", buff.type());
-    xw.setAttr(buffElement, "timeRemaining", buff.timeRemaining());
+    xw.openElement("buff");
+    xw.setAttr("type", buff.type());
+    xw.setAttr("timeRemaining", buff.timeRemaining());
+    xw.closeElement();
   }
   for (const auto &debuff : user.debuffs()) {
-    auto buffElement = xw.addChild("buff", e);
-    xw.setAttr(buffElement, "type", debuff.type());
-    xw.setAttr(buffElement, "timeRemaining", debuff.timeRemaining());
+    xw.openElement("buff");
+    xw.setAttr("type", debuff.type());
+    xw.setAttr("timeRemaining", debuff.timeRemaining());
+    xw.closeElement();
   }
+  xw.closeElement();
 
-  e = xw.addChild("knownRecipes");
+  xw.openElement("knownRecipes");
   for (const std::string &id : user.knownRecipes()) {
-    auto slotElement = xw.addChild("recipe", e);
-    xw.setAttr(slotElement, "id", id);
+    xw.openElement("recipe");
+    xw.setAttr("id", id);
+    xw.closeElement();
   }
+  xw.closeElement();
 
-  e = xw.addChild("knownConstructions");
+  xw.openElement("knownConstructions");
   for (const std::string &id : user.knownConstructions()) {
-    auto slotElement = xw.addChild("construction", e);
-    xw.setAttr(slotElement, "id", id);
+    xw.openElement("construction");
+    xw.setAttr("id", id);
+    xw.closeElement();
   }
+  xw.closeElement();
 
-  e = xw.addChild("talents");
+  xw.openElement("talents");
   for (auto pair : user.getClass().talentRanks()) {
     if (pair.second == 0) continue;
-    auto talentElem = xw.addChild("talent", e);
-    xw.setAttr(talentElem, "name", pair.first->name());
-    xw.setAttr(talentElem, "rank", pair.second);
+    xw.openElement("talent");
+    xw.setAttr("name", pair.first->name());
+    xw.setAttr("rank", pair.second);
+    xw.closeElement();
   }
+  xw.closeElement();
 
-  e = xw.addChild("otherSpells");
+  xw.openElement("otherSpells");
   for (auto spellID : user.getClass().otherKnownSpells()) {
-    auto spellElem = xw.addChild("spell", e);
-    xw.setAttr(spellElem, "id", spellID);
+    xw.openElement("spell");
+    xw.setAttr("id", spellID);
+    xw.closeElement();
   }
+  xw.closeElement();
 
-  e = xw.addChild("spellCooldowns");
+  xw.openElement("spellCooldowns");
   for (const auto &pair : user.spellCooldowns()) {
     if (pair.second == 0) continue;
-    auto cooldownElem = xw.addChild("cooldown", e);
-    xw.setAttr(cooldownElem, "id", pair.first);
-    xw.setAttr(cooldownElem, "remaining", pair.second);
+    xw.openElement("cooldown");
+    xw.setAttr("id", pair.first);
+    xw.setAttr("remaining", pair.second);
+    xw.closeElement();
   }
+  xw.closeElement();
 
-  e = xw.addChild("quests");
+  xw.openElement("quests");
   for (const auto &completedQuestID : user.questsCompleted()) {
-    auto questElem = xw.addChild("completed", e);
-    xw.setAttr(questElem, "quest", completedQuestID);
+    xw.openElement("completed");
+    xw.setAttr("quest", completedQuestID);
+    xw.closeElement();
   }
   for (const auto &pair : user.questsInProgress()) {
     const auto &questID = pair.first;
-    auto questElem = xw.addChild("inProgress", e);
-    xw.setAttr(questElem, "quest", questID);
-    if (pair.second > 0) xw.setAttr(questElem, "timeRemaining", pair.second);
+    xw.openElement("inProgress");
+    xw.setAttr("quest", questID);
+    if (pair.second > 0) xw.setAttr("timeRemaining", pair.second);
     auto quest = findQuest(questID);
     for (const auto &objective : quest->objectives) {
       auto progress = user.questProgress(questID, objective.type, objective.id);
       if (progress == 0) continue;
-      auto progressElem = xw.addChild("progress", questElem);
-      xw.setAttr(progressElem, "type", objective.typeAsString());
-      xw.setAttr(progressElem, "id", objective.id);
-      xw.setAttr(progressElem, "qty", progress);
+      xw.openElement("progress");
+      xw.setAttr("type", objective.typeAsString());
+      xw.setAttr("id", objective.id);
+      xw.setAttr("qty", progress);
+      xw.closeElement();
     }
+    xw.closeElement();
   }
+  xw.closeElement();
 
-  e = xw.addChild("hotbar");
+  xw.openElement("hotbar");
   for (auto i = 0; i != user.hotbar().size(); ++i) {
     const auto &action = user.hotbar()[i];
     if (!action) continue;
-    auto actionElem = xw.addChild("button", e);
-    xw.setAttr(actionElem, "slot", i);
-    xw.setAttr(actionElem, "category", action.category);
-    xw.setAttr(actionElem, "id", action.id);
+    xw.openElement("button");
+    xw.setAttr("slot", i);
+    xw.setAttr("category", static_cast<int>(action.category));
+    xw.setAttr("id", action.id);
+    xw.closeElement();
   }
+  xw.closeElement();
 
   user.exploration.writeTo(xw);
 
-  xw.publish();
+  auto contents = xw.contents();
+  _userRecords.add(user.name(), contents);
+  _userDataWriter.write(user.name(), std::move(contents));
   decrementThreadCount();
 }
 
@@ -406,8 +447,14 @@ void Server::loadEntitiesFromString(const std::string &data,
   loadEntities(xr, shouldBeExcludedFromPersistentState);
 }
 
+static const auto ENTITIES_XML_FILE = "World/entities.world"s;
+static const auto ENTITIES_SHARDS = "World/entities"s;
+static const auto ENTITIES_BINARY_FILE = "World/entities.bin"s;  // Older saves
+static const auto ENTITIES_LOG = "World/entities.log"s;
+
 void Server::loadEntities(XmlReader &xr,
-                          bool shouldBeExcludedFromPersistentState) {
+                          bool shouldBeExcludedFromPersistentState,
+                          EntitiesBySavedSerial *savedSerials) {
   for (auto elem : xr.getChildren("permanentObject")) {
     std::string s;
     if (!xr.findAttr(elem, "id", s)) {
@@ -433,234 +480,170 @@ void Server::loadEntities(XmlReader &xr,
     Object &obj = addPermanentObject(type, p);
   }
 
-  for (auto elem : xr.getChildren("object")) {
-    std::string s;
-    if (!xr.findAttr(elem, "id", s)) {
-      _debug("Skipping importing object with no type.", Color::CHAT_ERROR);
-      continue;
-    }
+  for (auto elem : xr.getChildren("object"))
+    loadEntity(xr, elem, shouldBeExcludedFromPersistentState, savedSerials);
 
-    MapPoint p;
-    if (!xr.findAttr(elem, "x", p.x) || !xr.findAttr(elem, "y", p.y)) {
-      // Try old location format
-      auto location = xr.findChild("location", elem);
-      if (!location || !xr.findAttr(location, "x", p.x) ||
-          !xr.findAttr(location, "y", p.y)) {
-        _debug("Skipping importing object with invalid/no location",
-               Color::CHAT_ERROR);
-        continue;
-      }
-    }
+  for (auto elem : xr.getChildren("npc"))
+    loadEntity(xr, elem, shouldBeExcludedFromPersistentState, savedSerials);
 
-    const ObjectType *type = findObjectTypeByID(s);
-    if (type == nullptr) {
-      _debug << Color::CHAT_ERROR
-             << "Skipping importing object with unknown type \"" << s << "\"."
-             << Log::endl;
-      continue;
-    }
+  for (auto elem : xr.getChildren("droppedItem"))
+    loadEntity(xr, elem, shouldBeExcludedFromPersistentState, savedSerials);
+}
 
-    auto owner = Permissions::Owner{};
-    auto ownerElem = xr.findChild("owner", elem);
-    if (ownerElem) {
-      std::string type, name;
-      xr.findAttr(ownerElem, "type", type);
-      xr.findAttr(ownerElem, "name", name);
-      if (type == "player")
-        owner.type = Permissions::Owner::PLAYER;
-      else if (type == "city")
-        owner.type = Permissions::Owner::CITY;
-      else if (type == "noAccess")
-        owner.type = Permissions::Owner::NO_ACCESS;
-      else
-        _debug << Color::CHAT_ERROR << "Skipping bad object owner type \""
-               << type << "\"." << Log::endl;
-      owner.name = name;
-    }
+Entity *Server::loadEntity(XmlReader &xr, TiXmlElement *elem,
+                           bool shouldBeExcludedFromPersistentState,
+                           EntitiesBySavedSerial *savedSerials) {
+  auto saved = SavedEntity{};
+  if (!saved.readFromXML(xr, elem)) return nullptr;
 
-    Object &obj = addObject(type, p, owner);
-
-    // If static, mark them as such.  They will be excluded from being saved to
-    // file.
-    if (shouldBeExcludedFromPersistentState) obj.excludeFromPersistentState();
-
-    size_t n;
-    ItemSet gatherContents;
-    for (auto content : xr.getChildren("gatherable", elem)) {
-      if (!xr.findAttr(content, "id", s)) continue;
-      n = 1;
-      xr.findAttr(content, "quantity", n);
-      auto it = _items.find(s);
-      if (it == _items.end()) continue;
-      gatherContents.set(&*it, n);
-    }
-    obj.gatherable.setContents(gatherContents);
+  auto *entity = loadEntity(saved, shouldBeExcludedFromPersistentState);
+  if (entity && savedSerials && saved.serial.isInitialised())
+    (*savedSerials)[saved.serial] = entity;
+  return entity;
+}
 
-    size_t q;
-    // Default value to support transition of old data
-    Hitpoints health = Item::MAX_HEALTH;
-    for (auto inventory : xr.getChildren("inventory", elem)) {
-      assert(obj.hasContainer());
-      if (!xr.findAttr(inventory, "item", s)) continue;
-      if (!xr.findAttr(inventory, "slot", n)) continue;
-      q = 1;
-      xr.findAttr(inventory, "qty", q);
-      xr.findAttr(inventory, "health", health);
-      if (obj.objType().container().slots() <= n) {
-        _debug << Color::CHAT_ERROR
-               << "Skipping object with invalid inventory slot." << Log::endl;
-        continue;
-      }
-      auto &invSlot = obj.container().at(n);
-      invSlot.first = ServerItem::Instance::LoadFromFile(
-          &*_items.find(s),
-          ServerItem::Instance::ReportingInfo::InObjectContainer(), health);
-      invSlot.second = q;
-
-      auto n = 0;
-      if (xr.findAttr(inventory, "soulbound", n) && n != 0)
-        invSlot.first.onEquip();
-    }
+Entity *Server::loadEntity(const SavedEntity &saved,
+                           bool shouldBeExcludedFromPersistentState) {
+  switch (saved.kind) {
+    case SavedEntity::OBJECT:
+      return loadObject(saved, shouldBeExcludedFromPersistentState);
+    case SavedEntity::NPC:
+      return loadNPC(saved, shouldBeExcludedFromPersistentState);
+    case SavedEntity::DROPPED_ITEM:
+      return loadDroppedItem(saved);
+  }
+  return nullptr;
+}
 
-    for (auto merchant : xr.getChildren("merchant", elem)) {
-      size_t slot;
-      if (!xr.findAttr(merchant, "slot", slot)) continue;
-      if (slot >= obj.objType().merchantSlots()) continue;
-      std::string wareName, priceName;
-      if (!xr.findAttr(merchant, "wareItem", wareName) ||
-          !xr.findAttr(merchant, "priceItem", priceName))
-        continue;
-      auto wareIt = _items.find(wareName);
-      if (wareIt == _items.end()) continue;
-      auto priceIt = _items.find(priceName);
-      if (priceIt == _items.end()) continue;
-      size_t wareQty = 1, priceQty = 1;
-      xr.findAttr(merchant, "wareQty", wareQty);
-      xr.findAttr(merchant, "priceQty", priceQty);
-      obj.merchantSlot(slot) =
-          MerchantSlot(&*wareIt, wareQty, &*priceIt, priceQty);
-    }
+Object *Server::loadObject(const SavedEntity &saved,
+                           bool shouldBeExcludedFromPersistentState) {
+  const ObjectType *type = findObjectTypeByID(saved.typeID);
+  if (type == nullptr) {
+    _debug << Color::CHAT_ERROR
+           << "Skipping importing object with unknown type \"" << saved.typeID
+           << "\"." << Log::endl;
+    return nullptr;
+  }
+
+  Object &obj = addObject(type, saved.location, saved.owner);
 
-    obj.clearMaterialsRequired();
-    for (auto material : xr.getChildren("material", elem)) {
-      if (!xr.findAttr(material, "id", s)) continue;
-      if (!xr.findAttr(material, "qty", n)) continue;
-      auto it = _items.find(s);
-      if (it == _items.end()) continue;
-      obj.remainingMaterials().set(&*it, n);
+  // If static, mark them as such.  They will be excluded from being saved to
+  // file.
+  if (shouldBeExcludedFromPersistentState) obj.excludeFromPersistentState();
+
+  ItemSet gatherContents;
+  for (const auto &content : saved.gatherables) {
+    const auto *item = findItem(content.itemID);
+    if (!item) continue;
+    gatherContents.set(item, content.quantity);
+  }
+  obj.gatherable.setContents(gatherContents);
+
+  for (const auto &slot : saved.inventory) {
+    assert(obj.hasContainer());
+    if (obj.objType().container().slots() <= slot.slot) {
+      _debug << Color::CHAT_ERROR
+             << "Skipping object with invalid inventory slot." << Log::endl;
+      continue;
     }
+    const auto *item = findItem(slot.itemID);
+    if (!item) continue;
+    auto &invSlot = obj.container().at(slot.slot);
+    invSlot.first = ServerItem::Instance::LoadFromFile(
+        item, ServerItem::Instance::ReportingInfo::InObjectContainer(),
+        slot.health);
+    invSlot.second = slot.quantity;
+    if (slot.isSoulbound) invSlot.first.onEquip();
+  }
 
-    if (xr.findAttr(elem, "health", health)) obj.health(health);
+  for (const auto &ware : saved.wares) {
+    if (ware.slot >= obj.objType().merchantSlots()) continue;
+    const auto *wareItem = findItem(ware.wareItemID);
+    if (!wareItem) continue;
+    const auto *priceItem = findItem(ware.priceItemID);
+    if (!priceItem) continue;
+    obj.merchantSlot(ware.slot) = MerchantSlot(wareItem, ware.wareQuantity,
+                                               priceItem, ware.priceQuantity);
+  }
 
-    auto corpseTime = ms_t{};
-    if (xr.findAttr(elem, "corpseTime", corpseTime)) obj.corpseTime(corpseTime);
+  obj.clearMaterialsRequired();
+  for (const auto &material : saved.remainingMaterials) {
+    const auto *item = findItem(material.itemID);
+    if (!item) continue;
+    obj.remainingMaterials().set(item, material.quantity);
+  }
 
-    auto transformTimer = ms_t{};
-    if (xr.findAttr(elem, "transformTime", transformTimer))
-      obj.transformation.transformTimer(transformTimer);
+  if (saved.hasHealth) obj.health(saved.health);
 
-    auto vehicle = xr.findChild("vehicle", elem);
-    if (vehicle) {
-      auto driver = ""s;
-      if (xr.findAttr(vehicle, "driver", driver) && !driver.empty()) {
-        auto objAsVehicle = dynamic_cast<Vehicle *>(&obj);
-        if (objAsVehicle) {
-          objAsVehicle->driver(driver);
-        }
-      }
-    }
+  if (saved.corpseTime > 0) obj.corpseTime(saved.corpseTime);
+
+  if (saved.transformTime > 0)
+    obj.transformation.transformTimer(saved.transformTime);
+
+  if (!saved.driver.empty()) {
+    auto *objAsVehicle = obj.as<Vehicle>();
+    if (objAsVehicle) objAsVehicle->driver(saved.driver);
   }
 
-  for (auto elem : xr.getChildren("npc")) {
-    std::string s;
-    if (!xr.findAttr(elem, "id", s)) {
-      _debug("Skipping importing NPC with no type.", Color::CHAT_ERROR);
-      continue;
-    }
+  return &obj;
+}
 
-    MapPoint p;
-    if (!xr.findAttr(elem, "x", p.x) || !xr.findAttr(elem, "y", p.y)) {
-      // Try old location format
-      auto location = xr.findChild("location", elem);
-      if (!location || !xr.findAttr(location, "x", p.x) ||
-          !xr.findAttr(location, "y", p.y)) {
-        _debug("Skipping importing object with invalid/no location",
-               Color::CHAT_ERROR);
-        continue;
-      }
-    }
+NPC *Server::loadNPC(const SavedEntity &saved,
+                     bool shouldBeExcludedFromPersistentState) {
+  const NPCType *type =
+      dynamic_cast<const NPCType *>(findObjectTypeByID(saved.typeID));
+  if (type == nullptr) {
+    _debug << Color::CHAT_ERROR
+           << "Skipping importing NPC with unknown type \"" << saved.typeID
+           << "\"." << Log::endl;
+    return nullptr;
+  }
 
-    const NPCType *type = dynamic_cast<const NPCType *>(findObjectTypeByID(s));
-    if (type == nullptr) {
-      _debug << Color::CHAT_ERROR
-             << "Skipping importing NPC with unknown type \"" << s << "\"."
-             << Log::endl;
-      continue;
-    }
+  NPC &npc = addNPC(type, saved.location);
 
-    NPC &npc = addNPC(type, p);
-
-    if (shouldBeExcludedFromPersistentState) npc.excludeFromPersistentState();
-
-    auto health = Hitpoints{};
-    if (xr.findAttr(elem, "health", health)) npc.health(health);
-
-    auto corpseTime = ms_t{};
-    if (xr.findAttr(elem, "corpseTime", corpseTime)) npc.corpseTime(corpseTime);
-
-    auto ownerElem = xr.findChild("owner", elem);
-    if (ownerElem) {
-      std::string type, name;
-      xr.findAttr(ownerElem, "type", type);
-      xr.findAttr(ownerElem, "name", name);
-      if (type == "player")
-        npc.permissions.setPlayerOwner(name);
-      else if (type == "city")
-        npc.permissions.setCityOwner(name);
-      else if (type == "noAccess")
-        npc.permissions.setNoAccess();
-      else
-        _debug << Color::CHAT_ERROR << "Skipping bad NPC owner type \"" << type
-               << "\"." << Log::endl;
-    }
+  if (shouldBeExcludedFromPersistentState) npc.excludeFromPersistentState();
+
+  if (saved.hasHealth) npc.health(saved.health);
 
-    auto transformTimer = ms_t{};
-    if (xr.findAttr(elem, "transformTime", transformTimer))
-      npc.transformation.transformTimer(transformTimer);
+  if (saved.corpseTime > 0) npc.corpseTime(saved.corpseTime);
 
-    auto orderString = ""s;
-    if (xr.findAttr(elem, "order", orderString))
-      npc.ai.giveOrder(orderString == "stay" ? AI::ORDER_TO_STAY
-                                             : AI::ORDER_TO_FOLLOW);
+  switch (saved.owner.type) {
+    case Permissions::Owner::PLAYER:
+      npc.permissions.setPlayerOwner(saved.owner.name);
+      break;
+    case Permissions::Owner::CITY:
+      npc.permissions.setCityOwner(saved.owner.name);
+      break;
+    case Permissions::Owner::NO_ACCESS:
+      npc.permissions.setNoAccess();
+      break;
+    default:
+      break;
   }
 
-  for (auto elem : xr.getChildren("droppedItem")) {
-    std::string typeID;
-    xr.findAttr(elem, "type", typeID);
-    const auto *itemType = findItem(typeID);
-    if (!itemType) {
-      _debug("Skipping importing item with invalid type "s + typeID,
-             Color::CHAT_ERROR);
-      continue;
-    }
+  if (saved.transformTime > 0)
+    npc.transformation.transformTimer(saved.transformTime);
 
-    size_t quantity = 1;
-    xr.findAttr(elem, "qty", quantity);
+  if (saved.order != SavedEntity::NO_ORDER)
+    npc.ai.giveOrder(saved.order == SavedEntity::ORDER_TO_STAY
+                         ? AI::ORDER_TO_STAY
+                         : AI::ORDER_TO_FOLLOW);
 
-    auto p = MapPoint{};
-    if (!xr.findAttr(elem, "x", p.x) || !xr.findAttr(elem, "y", p.y)) {
-      // Try old location format
-      auto location = xr.findChild("location", elem);
-      if (!location || !xr.findAttr(location, "x", p.x) ||
-          !xr.findAttr(location, "y", p.y)) {
-        _debug("Skipping importing dropped item with invalid/no location",
-               Color::CHAT_ERROR);
-        continue;
-      }
-    }
+  return &npc;
+}
 
-    addEntity(new DroppedItem(*itemType, quantity, p));
+DroppedItem *Server::loadDroppedItem(const SavedEntity &saved) {
+  const auto *itemType = findItem(saved.typeID);
+  if (!itemType) {
+    _debug("Skipping importing item with invalid type "s + saved.typeID,
+           Color::CHAT_ERROR);
+    return nullptr;
   }
+
+  auto *droppedItem =
+      new DroppedItem(*itemType, saved.quantity, saved.location);
+  addEntity(droppedItem);
+  return droppedItem;
 }
 
 void Server::loadWorldState() {
@@ -677,7 +660,10 @@ void Server::loadWorldState() {
       auto dataFiles = getXMLFiles(_dataSource.string, "map.xml");
       for (auto file : dataFiles) loadEntitiesFromFile(file, true);
     }
-    if (loadExistingData) loadEntitiesFromFile("World/entities.world", false);
+    if (loadExistingData)
+      loadSavedEntities();
+    else
+      std::ofstream{ENTITIES_LOG, std::ios_base::trunc};
 
     if (!loadExistingData) break;
 
@@ -693,145 +679,267 @@ void Server::loadWorldState() {
   _dataLoaded = true;
 }
 
-void Object::writeToXML(XmlWriter &xw) const {
-  if (spawner() != nullptr) return;  // Spawned objects are not persistent.
+void Server::loadSavedEntities() {
+  auto savedSerials = EntitiesBySavedSerial{};
+
+  auto addEntities = [&](const std::vector<SavedEntity> &entities) {
+    for (const auto &saved : entities) {
+      auto *entity = loadEntity(saved, false);
+      if (entity && saved.serial.isInitialised())
+        savedSerials[saved.serial] = entity;
+    }
+  };
+
+  // Shards are read in parallel, but their entities are added in order.
+  auto sharded = ShardedWorldFile{ENTITIES_SHARDS};
+  auto binary = BinaryWorldFile{ENTITIES_BINARY_FILE};
+  auto shouldImportXML = cmdLineArgs.contains("import-world-xml");
+  if (!shouldImportXML && sharded.load()) {
+    _worldGeneration = sharded.generation();
+    const auto wereEntitiesLost = !sharded.isFromPreviousSave();
+    for (const auto &shard : sharded.damagedShards())
+      _debug("Failed to read "s + shard +
+                 (wereEntitiesLost ? "; its entities are lost"s : ""s),
+             Color::CHAT_ERROR);
+    if (sharded.isFromPreviousSave())
+      _debug("The latest world save is damaged; using the one before it"s,
+             Color::CHAT_ERROR);
+    for (const auto &shard : sharded.shards()) addEntities(shard.entities());
+
+  } else if (!shouldImportXML && binary.load()) {
+    _worldGeneration = binary.generation();
+    addEntities(binary.entities());
 
-  auto e = xw.addChild("object");
+  } else {
+    if (!shouldImportXML && std::ifstream{sharded.filename()})
+      _debug("Failed to read "s + sharded.filename() + "; using "s +
+                 ENTITIES_XML_FILE + " instead"s,
+             Color::CHAT_ERROR);
+    auto xr = XmlReader::FromFile(ENTITIES_XML_FILE);
+    loadEntities(xr, false, &savedSerials);
+    xr.findAttr(xr.findChild("generation"), "value", _worldGeneration);
+  }
 
-  xw.setAttr(e, "id", type()->id());
+  replayWorldChangeLog(savedSerials);
 
-  xw.setAttr(e, "x", location().x);
-  xw.setAttr(e, "y", location().y);
+  // Adding and restoring these entities marked them as changed, but their
+  // state is what was just read from disk.
+  for (Entity *entity : _entities) entity->markAsSaved();
+  _entitiesWithUnsavedChanges.clear();
+  _entitiesRemovedSinceSave.clear();
+}
 
-  for (auto &content : gatherable.contents()) {
-    auto contentE = xw.addChild("gatherable", e);
-    xw.setAttr(contentE, "id", content.first->id());
-    xw.setAttr(contentE, "quantity", content.second);
+void Server::replayWorldChangeLog(EntitiesBySavedSerial &savedSerials) {
+  auto log = std::ifstream{ENTITIES_LOG};
+  auto line = ""s;
+  auto numRecordsSkipped = 0;
+  while (std::getline(log, line)) {
+    if (line.empty()) continue;
+    auto xr = XmlReader::FromString(line);
+    if (!xr) {
+      ++numRecordsSkipped;  // e.g., cut short by a crash mid-write
+      continue;
+    }
+    for (auto record : xr.getAllChildren())
+      applyWorldChangeRecord(xr, record, savedSerials);
   }
 
-  if (permissions.hasOwner()) {
-    const auto &owner = permissions.owner();
-    auto ownerElem = xw.addChild("owner", e);
-    xw.setAttr(ownerElem, "type", owner.typeString());
-    xw.setAttr(ownerElem, "name", owner.name);
+  if (numRecordsSkipped > 0)
+    _debug("Skipped "s + toString(numRecordsSkipped) +
+               " unreadable records in "s + ENTITIES_LOG,
+           Color::CHAT_ERROR);
+}
+
+void Server::applyWorldChangeRecord(XmlReader &xr, TiXmlElement *record,
+                                    EntitiesBySavedSerial &savedSerials) {
+  // Records from before the last full save are already reflected in it.
+  auto generation = 0u;
+  xr.findAttr(record, "generation", generation);
+  if (generation != _worldGeneration) return;
+
+  auto savedSerial = Serial{};
+  if (!xr.findAttr(record, "serial", savedSerial)) return;
+
+  // Each record replaces whatever was there before.
+  auto it = savedSerials.find(savedSerial);
+  if (it != savedSerials.end()) {
+    removeEntity(*it->second);
+    savedSerials.erase(it);
   }
 
-  if (isMissingHealth()) xw.setAttr(e, "health", health());
+  if (record->Value() == "removed"s) return;
+  auto *entity = loadEntity(xr, record, false, nullptr);
+  if (entity) savedSerials[savedSerial] = entity;
+}
+
+bool Object::getSavedState(SavedEntity &saved) const {
+  // Spawned objects are not persistent.
+  if (spawner() != nullptr) return false;
+
+  saved.kind = SavedEntity::OBJECT;
+  saved.typeID = type()->id();
+  saved.location = location();
+  saved.serial = serial();
 
-  if (isDead() && corpseTime() > 0) xw.setAttr(e, "corpseTime", corpseTime());
+  for (auto &content : gatherable.contents())
+    saved.gatherables.push_back({content.first->id(), content.second});
 
-  if (transformation.transformTimer() > 0)
-    xw.setAttr(e, "transformTime", transformation.transformTimer());
+  if (permissions.hasOwner()) saved.owner = permissions.owner();
+
+  if (isMissingHealth()) {
+    saved.hasHealth = true;
+    saved.health = health();
+  }
+
+  if (isDead()) saved.corpseTime = corpseTime();
+
+  saved.transformTime = transformation.transformTimer();
 
   if (hasContainer()) {
     for (size_t i = 0; i != objType().container().slots(); ++i) {
       const auto &pair = container().at(i);
       if (pair.second == 0) continue;
-      auto invSlotE = xw.addChild("inventory", e);
-      xw.setAttr(invSlotE, "slot", i);
-      xw.setAttr(invSlotE, "item", pair.first.type()->id());
-      if (pair.second > 1) xw.setAttr(invSlotE, "qty", pair.second);
-      xw.setAttr(invSlotE, "health", pair.first.health());
-      if (pair.first.isSoulbound()) xw.setAttr(invSlotE, "soulbound", 1);
+      saved.inventory.push_back({i, pair.first.type()->id(), pair.second,
+                                 pair.first.health(),
+                                 pair.first.isSoulbound()});
     }
   }
 
-  const auto mSlots = merchantSlots();
+  const auto &mSlots = merchantSlots();
   for (size_t i = 0; i != mSlots.size(); ++i) {
     if (!mSlots[i]) continue;
-    auto mSlotE = xw.addChild("merchant", e);
-    xw.setAttr(mSlotE, "slot", i);
-    xw.setAttr(mSlotE, "wareItem", mSlots[i].wareItem->id());
-    xw.setAttr(mSlotE, "wareQty", mSlots[i].wareQty);
-    xw.setAttr(mSlotE, "priceItem", mSlots[i].priceItem->id());
-    xw.setAttr(mSlotE, "priceQty", mSlots[i].priceQty);
+    saved.wares.push_back({i, mSlots[i].wareItem->id(), mSlots[i].wareQty,
+                           mSlots[i].priceItem->id(), mSlots[i].priceQty});
   }
 
-  for (const auto &pair : remainingMaterials()) {
-    auto matE = xw.addChild("material", e);
-    xw.setAttr(matE, "id", pair.first->id());
-    xw.setAttr(matE, "qty", pair.second);
-  }
+  for (const auto &pair : remainingMaterials())
+    saved.remainingMaterials.push_back({pair.first->id(), pair.second});
 
-  auto asVehicle = dynamic_cast<const Vehicle *>(this);
-  if (asVehicle && !asVehicle->driver().empty()) {
-    auto vehicleE = xw.addChild("vehicle", e);
-    xw.setAttr(vehicleE, "driver", asVehicle->driver());
-  }
+  if (classTag() == 'v') saved.driver = as<Vehicle>()->driver();
+
+  return true;
 }
 
-void NPC::writeToXML(XmlWriter &xw) const {
-  auto e = xw.addChild("npc");
+bool NPC::getSavedState(SavedEntity &saved) const {
+  saved.kind = SavedEntity::NPC;
+  saved.typeID = type()->id();
+  saved.location = location();
+  saved.serial = serial();
 
-  xw.setAttr(e, "id", type()->id());
+  saved.hasHealth = true;
+  saved.health = health();
 
-  xw.setAttr(e, "x", location().x);
-  xw.setAttr(e, "y", location().y);
+  if (permissions.hasOwner()) saved.owner = permissions.owner();
 
-  xw.setAttr(e, "health", health());
+  saved.transformTime = transformation.transformTimer();
 
-  if (permissions.hasOwner()) {
-    const auto &owner = permissions.owner();
-    auto ownerElem = xw.addChild("owner", e);
-    xw.setAttr(ownerElem, "type", owner.typeString());
-    xw.setAttr(ownerElem, "name", owner.name);
-  }
+  saved.order = ai.currentOrder() == AI::ORDER_TO_FOLLOW
+                    ? SavedEntity::ORDER_TO_FOLLOW
+                    : SavedEntity::ORDER_TO_STAY;
 
-  if (transformation.transformTimer() > 0)
-    xw.setAttr(e, "transformTime", transformation.transformTimer());
+  if (isDead()) saved.corpseTime = corpseTime();
 
-  auto orderString =
-      ai.currentOrder() == AI::ORDER_TO_FOLLOW ? "follow" : "stay";
-  xw.setAttr(e, "order", orderString);
-
-  if (isDead() && corpseTime() > 0) xw.setAttr(e, "corpseTime", corpseTime());
+  return true;
 }
 
-void DroppedItem::writeToXML(XmlWriter &xw) const {
-  auto e = xw.addChild("droppedItem");
+bool DroppedItem::getSavedState(SavedEntity &saved) const {
+  saved.kind = SavedEntity::DROPPED_ITEM;
+  saved.typeID = _itemType.id();
+  saved.quantity = _quantity;
+  saved.location = location();
+  saved.serial = serial();
+  return true;
+}
 
-  xw.setAttr(e, "type", _itemType.id());
-  if (_quantity > 1) xw.setAttr(e, "qty", _quantity);
-  xw.setAttr(e, "x", location().x);
-  xw.setAttr(e, "y", location().y);
+// Write the entity, tagged with the world generation.  Returns false if the
+// entity isn't saved after all.
+static bool writeEntityRecord(const Entity &entity, XmlStreamWriter &xw,
+                              unsigned generation) {
+  auto saved = SavedEntity{};
+  if (!entity.getSavedState(saved)) return false;
+  saved.writeToXML(xw, generation);
+  return true;
 }
 
-void Server::saveData(const Entities &entities, const Wars &wars,
-                      const Cities &cities) {
+std::unique_ptr<WorldSaver::Snapshot> Server::snapshotWorld(SaveScope scope) {
+  const auto startTime = SDL_GetTicks();
+  auto snapshot = std::make_unique<WorldSaver::Snapshot>();
+
   // Entities
-#ifndef SINGLE_THREAD
-  static std::mutex entitiesFileMutex;
-  entitiesFileMutex.lock();
-#endif
-  XmlWriter xw("World/entities.world");
+  if (scope == SAVE_EVERYTHING) {
+    ++_worldGeneration;
+    _lastWorldCompaction = SDL_GetTicks();
+
+    auto entities = std::make_unique<ShardedWorldFile>(
+        ENTITIES_SHARDS, _map.height() * Map::TILE_H);
+    entities->generation(_worldGeneration);
+
+    // A copy for operators to read or edit, if they've asked for one
+    auto xmlCopy = std::unique_ptr<XmlStreamWriter>{};
+    if (cmdLineArgs.contains("export-world-xml")) {
+      xmlCopy = std::make_unique<XmlStreamWriter>(
+          XmlStreamWriter::Document(ENTITIES_XML_FILE));
+      xmlCopy->openElement("generation");
+      xmlCopy->setAttr("value", _worldGeneration);
+      xmlCopy->closeElement();
+    }
 
-  for (const Entity *entity : entities) {
-    if (entity->excludedFromPersistentState()) continue;
-    entity->writeToXML(xw);
-  }
+    for (Entity *entity : _entities) {
+      entity->markAsSaved();
+      if (entity->excludedFromPersistentState()) continue;
+      auto saved = SavedEntity{};
+      if (!entity->getSavedState(saved)) continue;
+      if (xmlCopy) saved.writeToXML(*xmlCopy, _worldGeneration);
+      entities->add(std::move(saved));
+    }
+
+    snapshot->shardedFiles.push_back(std::move(entities));
+    if (xmlCopy) snapshot->files.push_back(std::move(xmlCopy));
+    snapshot->logsToClear.push_back(ENTITIES_LOG);
+    snapshot->isComplete = true;
 
-  xw.publish();
-#ifndef SINGLE_THREAD
-  entitiesFileMutex.unlock();
-#endif
+  } else {
+    auto changes = std::make_unique<XmlStreamWriter>(
+        XmlStreamWriter::Records(ENTITIES_LOG));
+    auto addRemovalRecord = [&](Serial serial) {
+      changes->openElement("removed");
+      changes->setAttr("serial", serial.raw());
+      changes->setAttr("generation", _worldGeneration);
+      changes->closeElement();
+    };
+
+    for (auto serial : _entitiesRemovedSinceSave) addRemovalRecord(serial);
+
+    for (auto serial : _entitiesWithUnsavedChanges) {
+      auto *entity = _entities.find(serial);
+      if (!entity) continue;  // Removed since
+      entity->markAsSaved();
+      if (entity->excludedFromPersistentState()) continue;
+      auto wasWritten = writeEntityRecord(*entity, *changes, _worldGeneration);
+      if (!wasWritten) addRemovalRecord(serial);
+    }
+
+    if (!changes->isEmpty()) snapshot->logEntries.push_back(std::move(changes));
+  }
+  _entitiesWithUnsavedChanges.clear();
+  _entitiesRemovedSinceSave.clear();
 
   // Wars
-#ifndef SINGLE_THREAD
-  static std::mutex warsFileMutex;
-  warsFileMutex.lock();
-#endif
-  wars.writeToXMLFile("World/wars.world");
-#ifndef SINGLE_THREAD
-  warsFileMutex.unlock();
-#endif
+  auto wars = std::make_unique<XmlStreamWriter>(
+      XmlStreamWriter::Document("World/wars.world"));
+  _wars.writeToXML(*wars);
+  snapshot->files.push_back(std::move(wars));
 
   // Cities
-#ifndef SINGLE_THREAD
-  static std::mutex citiesFileMutex;
-  citiesFileMutex.lock();
-#endif
-  cities.writeToXMLFile("World/cities.world");
-#ifndef SINGLE_THREAD
-  citiesFileMutex.unlock();
-#endif
+  auto cities = std::make_unique<XmlStreamWriter>(
+      XmlStreamWriter::Document("World/cities.world"));
+  _cities.writeToXML(*cities);
+  snapshot->files.push_back(std::move(cities));
+
+  snapshot->pauseTime = SDL_GetTicks() - startTime;
+  return snapshot;
+}
+
+void Server::saveWorld(SaveScope scope) {
+  _worldSaver.save(snapshotWorld(scope));
 }
@@ -1,40 +1,28 @@
 #include <ctime>
 #include <fstream>
+#include <thread>
 #include <utility>
 
+#include "../threadNaming.h"
 #include "../versionUtil.h"
 #include "Server.h"
 
-static int toSeconds(_FILETIME windowsTime) {
-  ULONGLONG timeLastOnline = (((ULONGLONG)windowsTime.dwHighDateTime) << 32) +
-                             windowsTime.dwLowDateTime;
-  _FILETIME ftNow;
-  _SYSTEMTIME st;
-  GetSystemTime(&st);
-  SystemTimeToFileTime(&st, &ftNow);
-  ULONGLONG timeNow =
-      (((ULONGLONG)ftNow.dwHighDateTime) << 32) + ftNow.dwLowDateTime;
-
-  auto timeOffline = timeNow - timeLastOnline;
-
-  static const auto SECONDS = ((ULONGLONG)10000000);
-  return static_cast<int>(timeOffline / SECONDS);
-}
-
 void Server::writeUserToFile(const User &user, std::ostream &stream) const {
-  const auto isOnline = user.hasSocket();
-  auto secondsOnlineOrOffline =
-      isOnline ? user.secondsPlayedThisSession() : user.secondsOffline;
+  const auto isOnline = user.timeLastOnline == 0;
 
   const auto className =
       &user.getClass() ? user.getClass().type().id() : "None";
 
   stream << "\n{"
          << "name: \"" << user.name() << "\","
-         << "online: " << user.hasSocket() << ","
-         << "secondsPlayed: " << user.secondsPlayed() << ","
-         << "secondsOnlineOrOffline: " << secondsOnlineOrOffline << ","
-         << "class: \"" << className << "\","
+         << "online: " << isOnline << ","
+         << "secondsPlayed: " << user.secondsPlayed() << ",";
+  if (isOnline)
+    stream << "secondsOnlineOrOffline: " << user.secondsPlayedThisSession()
+           << ",";
+  else
+    stream << "lastOnline: " << user.timeLastOnline << ",";
+  stream << "class: \"" << className << "\","
          << "level: \"" << user.level() << "\","
          << "xp: \"" << user.xp() << "\","
          << "xpNeeded: \"" << user.XP_PER_LEVEL[user.level()] << "\","
@@ -72,31 +60,27 @@ void Server::writeUserToFile(const User &user, std::ostream &stream) const {
   stream << "},";
 }
 
-static std::map<std::string, int> getUsersFromFiles() {
-  // Name -> seconds offline
-  std::map<std::string, int> users{};
-  auto findData = WIN32_FIND_DATA{};
-  auto handle = FindFirstFile("Users\\*.usr", &findData);
-  if (handle != INVALID_HANDLE_VALUE) {
-    BOOL fileFound = 1;
-    while (fileFound) {
-      auto name = std::string(findData.cFileName);
-      name = name.substr(0, name.size() - 4);
-      auto secondsOffline = toSeconds(findData.ftLastWriteTime);
-      users[name] = secondsOffline;
-
-      fileFound = FindNextFile(handle, &findData);
-    }
-  }
+std::string Server::offlineUserEntry(const User &user) const {
+  auto oss = std::ostringstream{};
+  writeUserToFile(user, oss);
+  return oss.str();
+}
+
+void Server::summariseOfflineUsers() {
+  for (const auto &account : _accounts.timesWritten()) {
+    if (_usersByName.count(account.first) == 1) continue;
 
-  return users;
+    auto user = User{account.first, {}, nullptr};
+    readUserData(user, false);
+    user.timeLastOnline = account.second;
+    _publishedStats.addOfflineUser(user, offlineUserEntry(user));
+  }
 }
 
-void Server::publishStats() {
-  static auto publishingStats = false;
-  if (publishingStats) return;
-  publishingStats = true;
-  incrementThreadCount();
+void Server::publishStats() const {
+  // If the last write hasn't finished, skip this one rather than have two
+  // threads writing the same file.
+  if (_isWritingStats.exchange(true)) return;
 
   std::ostringstream oss;
 
@@ -111,6 +95,9 @@ void Server::publishStats() {
   oss << "constructions: " << _numBuildableObjects << ",\n";
   oss << "quests: " << _quests.size() << ",\n";
 
+  oss << "online: " << _usersByName.size() << ",\n";
+  _publishedStats.writeTotals(oss);
+
   oss << "users: [";
 
   // Online users
@@ -118,27 +105,20 @@ void Server::publishStats() {
     writeUserToFile(*userEntry.second, oss);
 
   // Ofline users
-  auto offlineUsers = getUsersFromFiles();
-  for (const auto &offlineUser : offlineUsers) {
-    auto userIsOnline =
-        _usersByName.find(offlineUser.first) != _usersByName.end();
-    if (userIsOnline) continue;
-
-    auto user = User{offlineUser.first, {}, nullptr};
-    readUserData(user, false);
-    user.secondsOffline = offlineUser.second;
-
-    writeUserToFile(user, oss);
-  }
+  oss << _publishedStats.offlineUserEntries();
 
   oss << "\n],\n";
 
   oss << "\n};\n";
 
-  std::ofstream{"logging/stats.js"} << oss.str();
-
-  decrementThreadCount();
-  publishingStats = false;
+  // Only the writing happens on another thread
+  std::thread([this, stats = oss.str()]() {
+    setThreadName("Publishing server stats");
+    incrementThreadCount();
+    std::ofstream{"logging/stats.js"} << stats;
+    _isWritingStats = false;
+    decrementThreadCount();
+  }).detach();
 }
 
 void Server::logNumberOfOnlineUsers() const {
@@ -147,6 +127,15 @@ void Server::logNumberOfOnlineUsers() const {
       << currentTime << "," << _usersByName.size() << std::endl;
 }
 
+void Server::reportStartupProfile() {
+  _startupProfile.finish();
+  if (_isTestServer) return;
+
+  for (const auto &line : _startupProfile.reportLines()) _debug(line);
+  auto csv = std::ofstream{"logging/startup.csv", std::ofstream::app};
+  _startupProfile.writeCSVRows(csv, time(nullptr), version());
+}
+
 void Server::generateDurabilityList() {
   auto os = std::ofstream{"durability.csv"};
 
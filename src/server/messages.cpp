@@ -61,8 +61,8 @@ HANDLE_MESSAGE(CL_LOGIN_EXISTING) {
   if (userIsAlreadyLoggedIn) RETURN_WITH(WARNING_DUPLICATE_USERNAME)
 
   // Check that user exists
-  auto userFile = _userFilesPath + username + ".usr";
-  if (!fileExists(userFile)) {
+  auto record = findUserRecord(username);
+  if (!record) {
 #ifndef _DEBUG
     RETURN_WITH(WARNING_USER_DOESNT_EXIST)
 #else
@@ -72,10 +72,10 @@ HANDLE_MESSAGE(CL_LOGIN_EXISTING) {
 #endif
   }
 
-  auto xr = XmlReader::FromFile(_userFilesPath + username + ".usr");
-  auto elem = xr.findChild("general");
+  // The same record is then used by readUserData()
+  auto elem = record->findChild("general");
   auto savedPwHash = ""s;
-  xr.findAttr(elem, "passwordHash", savedPwHash);
+  XmlReader::findAttr(elem, "passwordHash", savedPwHash);
   if (savedPwHash != passwordHash) {
     sendMessage(client, WARNING_WRONG_PASSWORD);
     return;
@@ -99,8 +99,8 @@ HANDLE_MESSAGE(CL_LOGIN_NEW) {
   if (!isUsernameValid(name)) RETURN_WITH(WARNING_INVALID_USERNAME)
 
   // Check that user doesn't exist
-  auto userFile = _userFilesPath + name + ".usr";
-  if (fileExists(userFile)) RETURN_WITH(WARNING_NAME_TAKEN)
+  _userDataWriter.waitUntilWritten(name);
+  if (_accounts.contains(name)) RETURN_WITH(WARNING_NAME_TAKEN)
 
   addUser(client, name, pwHash, classID);
 }
@@ -336,8 +336,10 @@ HANDLE_MESSAGE(CL_DROP) {
   // Alert relevant users
   if (serial.isInventory() || serial.isGear())
     sendInventoryMessage(user, slot, serial);
-  else
+  else {
+    info.object->markAsChanged();
     info.object->tellRelevantUsersAboutInventorySlot(slot);
+  }
 }
 
 HANDLE_MESSAGE(CL_PICK_UP_DROPPED_ITEM) {
@@ -405,6 +407,7 @@ HANDLE_MESSAGE(CL_SWAP_ITEMS) {
 
     // Remove from object requirements
     to.object->remainingMaterials().remove(materialType, qtyToTake);
+    to.object->markAsChanged();
     for (const User *otherUser : findUsersInArea(user.location()))
       if (to.object->permissions.doesUserHaveAccess(otherUser->name()))
         sendConstructionMaterialsMessage(*otherUser, *to.object);
@@ -535,14 +538,18 @@ HANDLE_MESSAGE(CL_SWAP_ITEMS) {
   // Alert relevant users
   if (obj1.isInventory() || obj1.isGear())
     sendInventoryMessage(user, slot1, obj1);
-  else
+  else {
+    from.object->markAsChanged();
     from.object->tellRelevantUsersAboutInventorySlot(slot1);
+  }
 
   if (obj2.isInventory() || obj2.isGear()) {
     sendInventoryMessage(user, slot2, obj2);
     ProgressLock::triggerUnlocks(user, ProgressLock::ITEM, toItem.type());
-  } else
+  } else {
+    to.object->markAsChanged();
     to.object->tellRelevantUsersAboutInventorySlot(slot2);
+  }
 }
 
 HANDLE_MESSAGE(CL_TAKE_ITEM) {
@@ -591,11 +598,12 @@ HANDLE_MESSAGE(CL_TAKE_ITEM) {
     pEnt->tellRelevantUsersAboutLootSlot(slot);
 
   else {  // Container
-    auto *asObject = dynamic_cast<const Object *>(pEnt);
+    auto *asObject = dynamic_cast<Object *>(pEnt);
     if (!asObject) {
       SERVER_ERROR("Don't know how to handle TAKE_ITEM request");
       return;
     }
+    asObject->markAsChanged();
     asObject->tellRelevantUsersAboutInventorySlot(slot);
   }
 }
@@ -720,6 +728,7 @@ HANDLE_MESSAGE(CL_REPAIR_ITEM) {
   READ_ARGS(serial, slot);
 
   ServerItem::Instance *itemToRepair = nullptr;
+  Object *containingObject = nullptr;
   if (serial.isInventory())
     itemToRepair = &user.inventory(slot).first;
   else if (serial.isGear())
@@ -737,6 +746,7 @@ HANDLE_MESSAGE(CL_REPAIR_ITEM) {
     if (slot >= numSlots) RETURN_WITH(ERROR_INVALID_SLOT)
 
     itemToRepair = &obj->container().at(slot).first;
+    containingObject = obj;
   }
 
   const auto &repairInfo = itemToRepair->type()->repairInfo();
@@ -766,6 +776,7 @@ HANDLE_MESSAGE(CL_REPAIR_ITEM) {
   auto wasBroken = itemToRepair->isBroken();
 
   itemToRepair->repair();
+  if (containingObject) containingObject->markAsChanged();
 
   if (wasBroken) user.updateStats();
 }
@@ -940,7 +951,7 @@ HANDLE_MESSAGE(DG_GIVE_OBJECT) {
     auto owner = Permissions::Owner{Permissions::Owner::PLAYER, user.name()};
     auto &obj = addObject(ot, user.location() + MapPoint{50, 0}, owner);
     if (obj.isBeingBuilt()) {
-      obj.remainingMaterials().clear();
+      obj.clearMaterialsRequired();
       sendConstructionMaterialsMessage(user, obj);
     }
   }
@@ -981,6 +992,13 @@ HANDLE_MESSAGE(DG_SIMULATE_YIELDS) {
   objType->yield.simulate(user);
 }
 
+HANDLE_MESSAGE(DG_RELOAD_DATA) {
+  CHECK_NO_ARGS;
+
+  if (!isDebug()) return;
+  reloadData();
+}
+
 #define SEND_MESSAGE_TO_HANDLER(MESSAGE_CODE)           \
   case MESSAGE_CODE:                                    \
     handleMessage<MESSAGE_CODE>(client, *user, parser); \
@@ -1012,6 +1030,8 @@ void Server::handleBufferedMessages(const Socket &client,
       User &userRef = const_cast<User &>(*it);
       user = &userRef;
       user->contact();
+      // Most messages lead to something worth saving.
+      if (msgCode != CL_PING) user->markAsChanged();
     }
 
     auto &iss = parser.iss;
@@ -1053,6 +1073,7 @@ void Server::handleBufferedMessages(const Socket &client,
       SEND_MESSAGE_TO_HANDLER(DG_SPAWN)
       SEND_MESSAGE_TO_HANDLER(DG_UNLOCK)
       SEND_MESSAGE_TO_HANDLER(DG_SIMULATE_YIELDS)
+      SEND_MESSAGE_TO_HANDLER(DG_RELOAD_DATA)
 
       case CL_CONSTRUCT_FROM_ITEM:
       case CL_CONSTRUCT_FROM_ITEM_FOR_CITY: {
@@ -1267,6 +1288,7 @@ void Server::handleBufferedMessages(const Socket &client,
         if (priceIt == _items.end()) BREAK_WITH(ERROR_INVALID_ITEM)
         MerchantSlot &mSlot = obj->merchantSlot(slot);
         mSlot = MerchantSlot(&*wareIt, wareQty, &*priceIt, priceQty);
+        obj->markAsChanged();
 
         // Alert watchers
         obj->tellRelevantUsersAboutMerchantSlot(slot);
@@ -1287,6 +1309,7 @@ void Server::handleBufferedMessages(const Socket &client,
         if (slots == 0) BREAK_WITH(ERROR_NOT_MERCHANT)
         if (slot >= slots) BREAK_WITH(ERROR_INVALID_MERCHANT_SLOT)
         obj->merchantSlot(slot) = MerchantSlot();
+        obj->markAsChanged();
 
         // Alert watchers
         obj->tellRelevantUsersAboutMerchantSlot(slot);
@@ -2058,6 +2081,7 @@ void Server::handle_CL_AUTO_CONSTRUCT(User &user, Serial serial) {
   auto remainder = user.removeItems(materialsToLookFor);
   auto materialsAdded = materialsToLookFor - remainder;
   obj->remainingMaterials().remove(materialsAdded);
+  obj->markAsChanged();
 
   // Return items to user
   for (auto &pair : materialsAdded) {
@@ -2244,29 +2268,28 @@ void Server::sendRelevantEntitiesToUser(const User &user) {
   }
 
   // (Owned objects)
-  for (auto pEntity : _entities) {
-    if (pEntity->spawner()) continue;  // Optimisation and assumption
-
-    // Player owns directly
-    auto userOwnsThisObject = _objectsByOwner.isObjectOwnedBy(
-        pEntity->serial(), {Permissions::Owner::PLAYER, user.name()});
-    if (userOwnsThisObject) {
-      entitiesToDescribe.insert(pEntity);
-
-      // Object-specific stuff
-      auto *pObject = dynamic_cast<const Object *>(pEntity);
-      if (pObject && !pEntity->isDead())
-        user.registerObjectIfPlayerUnique(pObject->objType());
-
-      continue;
+  const auto &ownedByUser = _objectsByOwner.getObjectsWithSpecificOwner(
+      {Permissions::Owner::PLAYER, user.name()});
+  for (auto serial : ownedByUser) {
+    const auto *pEntity = _entities.find(serial);
+    if (!pEntity) continue;
+    entitiesToDescribe.insert(pEntity);
+
+    // Object-specific stuff
+    auto *pObject = dynamic_cast<const Object *>(pEntity);
+    if (pObject && !pEntity->isDead())
+      user.registerObjectIfPlayerUnique(pObject->objType());
+  }
+
+  // (City-owned objects)
+  const auto city = _cities.getPlayerCity(user.name());
+  if (!city.empty()) {
+    const auto &ownedByCity = _objectsByOwner.getObjectsWithSpecificOwner(
+        {Permissions::Owner::CITY, city});
+    for (auto serial : ownedByCity) {
+      const auto *pEntity = _entities.find(serial);
+      if (pEntity) entitiesToDescribe.insert(pEntity);
     }
-
-    // City owns
-    if (!_cities.isPlayerInACity(user.name())) continue;
-    auto cityOwnsThisObject = _objectsByOwner.isObjectOwnedBy(
-        pEntity->serial(),
-        {Permissions::Owner::CITY, _cities.getPlayerCity(user.name())});
-    if (cityOwnsThisObject) entitiesToDescribe.insert(pEntity);
   }
 
   // Send
@@ -41,6 +41,7 @@ void Container::removeItems(const ItemSet &items) {
       if (remaining.isEmpty()) break;
     }
   }
+  if (!invSlotsChanged.empty()) _parent.markAsChanged();
   for (size_t slotNum : invSlotsChanged)
     _parent.tellRelevantUsersAboutInventorySlot(slotNum);
 }
@@ -51,6 +52,7 @@ void Container::removeAll() {
     invSlot.first = {};
     invSlot.second = 0;
   }
+  _parent.markAsChanged();
   for (size_t slotNum = 0; slotNum != _container.size(); ++slotNum)
     _parent.tellRelevantUsersAboutInventorySlot(slotNum);
 }
@@ -88,6 +90,7 @@ void Container::addItems(const ServerItem *item, size_t qty) {
   if (qty > 0)
     SERVER_ERROR("items left over when trying to add to a container");
 
+  if (!changedSlots.empty()) _parent.markAsChanged();
   for (auto slot : changedSlots)
     _parent.tellRelevantUsersAboutInventorySlot(slot);
 }
@@ -8,6 +8,7 @@ Object::Object(const ObjectType *type, const MapPoint &loc)
     : Entity(type, loc),
       QuestNode(*type, serial()),
       _disappearTimer(type->disappearsAfter()) {
+  classTag('o');
   objType().incrementCounter();
 
   if (type != &User::OBJECT_TYPE) type->initStrengthAndMaxHealth();
@@ -17,10 +18,14 @@ Object::Object(const ObjectType *type, const MapPoint &loc)
   onSetType();
 }
 
-Object::Object(Serial serial) : Entity(serial), QuestNode(QuestNode::Dummy()) {}
+Object::Object(Serial serial) : Entity(serial), QuestNode(QuestNode::Dummy()) {
+  classTag('o');
+}
 
 Object::Object(const MapPoint &loc)
-    : Entity(loc), QuestNode(QuestNode::Dummy()) {}
+    : Entity(loc), QuestNode(QuestNode::Dummy()) {
+  classTag('o');
+}
 
 Object::~Object() {
   if (permissions.hasOwner()) {
@@ -62,10 +67,17 @@ void Object::onEnergyChange() {
   Entity::onEnergyChange();
 }
 
+void Object::refreshCapabilities() {
+  Entity::refreshCapabilities();
+  setCapability(GRANTS_BUFF, objType().grantsBuff());
+  setCapability(IS_GATE, objType().isGate());
+}
+
 void Object::onSetType(bool shouldSkipConstruction) {
   Entity::onSetType(shouldSkipConstruction);
 
   delete _container;
+  _container = nullptr;
   if (objType().hasContainer()) {
     _container = objType().container().instantiate(*this);
   }
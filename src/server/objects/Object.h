@@ -12,7 +12,6 @@
 #include "ObjectType.h"
 
 class User;
-class XmlWriter;
 
 // A server-side representation of an in-game object
 class Object : public Entity, public QuestNode, public DamageOnUse {
@@ -34,7 +33,7 @@ class Object : public Entity, public QuestNode, public DamageOnUse {
   virtual ~Object();
 
   const ObjectType &objType() const {
-    return *dynamic_cast<const ObjectType *>(type());
+    return *static_cast<const ObjectType *>(type());
   }
 
   void accountForOwnershipByUser(const User &owner) const override;
@@ -51,7 +50,10 @@ class Object : public Entity, public QuestNode, public DamageOnUse {
   }
   const ItemSet &remainingMaterials() const { return _remainingMaterials; }
   ItemSet &remainingMaterials() { return _remainingMaterials; }
-  void clearMaterialsRequired() { _remainingMaterials.clear(); }
+  void clearMaterialsRequired() {
+    _remainingMaterials.clear();
+    markAsChanged();
+  }
 
   bool hasContainer() const { return _container != nullptr; }
   Container &container() { return *_container; }
@@ -68,11 +70,14 @@ class Object : public Entity, public QuestNode, public DamageOnUse {
 
   void setAsPermanent() { _isPermanent = true; }
 
-  virtual char classTag() const override { return 'o'; }
+  // Users and vehicles are also objects.
+  static bool hasClassTag(char tag) {
+    return tag == 'o' || tag == 'u' || tag == 'v';
+  }
 
   ms_t timeToRemainAsCorpse() const override { return 43200000; }  // 12 hours
 
-  void writeToXML(XmlWriter &xw) const override;
+  bool getSavedState(SavedEntity &saved) const override;
 
   void update(ms_t timeElapsed) override;
 
@@ -82,6 +87,7 @@ class Object : public Entity, public QuestNode, public DamageOnUse {
   bool canBeAttackedBy(const User &) const override;
 
   virtual void onSetType(bool shouldSkipConstruction = false) override;
+  void refreshCapabilities() override;
 
   void sendInfoToClient(const User &targetUser,
                         bool isNew = false) const override;
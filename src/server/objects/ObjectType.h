@@ -86,6 +86,7 @@ class ObjectType : public EntityType, public QuestNodeType {
   }
   void decrementCounter() const { --_numInWorld; }
   size_t numInWorld() const { return _numInWorld; }
+  void numInWorld(size_t n) { _numInWorld = n; }
   void makeUniquePerPlayer(const std::string &category) {
     _playerUniqueCategory = category;
   }
@@ -32,11 +32,15 @@ class TestServer {
   std::set<ServerItem> &items() { return _server->_items; }
   const std::set<ServerItem> &items() const { return _server->_items; }
   std::set<User> &users() { return _server->_users; }
+  const std::set<SRecipe> &recipes() const { return _server->_recipes; }
   std::vector<Spawner> &spawners() { return _server->_spawners; }
   Wars &wars() { return _server->_wars; }
   Cities &cities() { return _server->_cities; }
   ObjectsByOwner &objectsByOwner() { return _server->_objectsByOwner; }
   Kings &kings() { return _server->_kings; }
+  const PublishedStats &publishedStats() const {
+    return _server->_publishedStats;
+  }
   const std::map<char, Terrain *> &terrainTypes() const {
     return _server->_terrainTypes;
   }
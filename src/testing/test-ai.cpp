@@ -3,6 +3,8 @@
 #include "TestServer.h"
 #include "testing.h"
 
+extern Args cmdLineArgs;
+
 TEST_CASE_METHOD(ServerAndClientWithData, "NPCs chain pull") {
   GIVEN("a user with a spear") {
     useData(R"(
@@ -505,4 +507,53 @@ TEST_CASE_METHOD(ServerAndClientWithData, "Pathfinding") {
   }
 }
 
+TEST_CASE_METHOD(ServerAndClientWithData,
+                 "Idle NPCs near users are processed every tick") {
+  cmdLineArgs.remove("ai-at-full-rate");
+
+  // Given a bear that the user can see, but too far away to notice the user
+  useData(R"(
+    <npcType id="bear" />
+  )");
+  auto &bear = server->addNPC("bear", user->location() + MapPoint{0, 200});
+  WAIT_UNTIL(bear.ai.timesProcessed() > 0);
+
+  // When a second passes
+  const auto timesBefore = bear.ai.timesProcessed();
+  REPEAT_FOR_MS(1000);
+
+  // Then it is processed more often than it would be if it were out of sight
+  CHECK(bear.ai.timesProcessed() - timesBefore >
+        1000 / AI::INTERVAL_WHEN_NEARBY + 1);
+  CHECK(bear.ai.state == AI::IDLE);
+
+  cmdLineArgs.add("ai-at-full-rate");
+}
+
+TEST_CASE_METHOD(ServerAndClientWithData,
+                 "Idle NPCs far from users are processed less often") {
+  cmdLineArgs.remove("ai-at-full-rate");
+
+  // Given a bear more than twice the cull distance from the user
+  useData(R"(
+    <npcType id="bear" />
+  )");
+  auto &bear = server->addNPC("bear", {3000, 3000});
+  WAIT_UNTIL(bear.ai.timesProcessed() > 0);
+
+  // When three intervals pass
+  const auto timesBefore = bear.ai.timesProcessed();
+  REPEAT_FOR_MS(3 * AI::INTERVAL_WHEN_DISTANT);
+
+  // Then it is processed at most once per interval
+  const auto timesProcessed = bear.ai.timesProcessed() - timesBefore;
+  CHECK(timesProcessed >= 2);
+  CHECK(timesProcessed <= 4);
+
+  // And each time, it is given all the time since it was last processed
+  CHECK(bear.ai.lastTimeProcessedFor() >= AI::INTERVAL_WHEN_DISTANT);
+
+  cmdLineArgs.add("ai-at-full-rate");
+}
+
 // Make NPCs invincible if they can't path to user
@@ -0,0 +1,98 @@
+#include <cstdio>
+
+#include "../parallel.h"
+#include "../server/FileTransaction.h"
+#include "../server/ShardedWorldFile.h"
+#include "TestFixtures.h"
+#include "testing.h"
+
+// These are hidden; run them explicitly with "[.benchmark]".
+
+TEST_CASE_METHOD(ServerAndClientWithData,
+                 "Collision and proximity checks among many objects",
+                 "[.benchmark]") {
+  GIVEN("a crowd of rocks, gates and buff-granting fires") {
+    useData(R"(
+      <buff id="warm" />
+      <objectType id="rock">
+        <collisionRect x="-1" y="-1" w="2" h="2" />
+      </objectType>
+      <objectType id="gate" isGate="1">
+        <collisionRect x="-1" y="-1" w="2" h="2" />
+      </objectType>
+      <objectType id="fire">
+        <collisionRect x="-1" y="-1" w="2" h="2" />
+        <grantsBuff id="warm" radius="20" />
+      </objectType>
+    )");
+
+    const auto types = std::vector<std::string>{"rock", "gate", "fire"};
+    auto i = 0;
+    for (auto x = 5.0; x < 300.0; x += 15.0)
+      for (auto y = 5.0; y < 300.0; y += 15.0)
+        server->addObject(types[i++ % types.size()], {x, y}, user->name());
+
+    BENCHMARK("Location validity for a user") {
+      return (*server)->isLocationValid(MapPoint{150, 150}, *user);
+    };
+
+    BENCHMARK("Object-buff scan after a user moves") { user->onMove(); };
+  }
+}
+
+TEST_CASE("Login storm", "[.benchmark]") {
+  GIVEN("many users with existing accounts") {
+    const auto NUM_USERS = 30;
+    auto names = std::vector<std::string>{};
+    for (auto i = 0; i != NUM_USERS; ++i)
+      names.push_back("Storm"s + static_cast<char>('a' + i / 26) +
+                      static_cast<char>('a' + i % 26));
+
+    auto s = TestServer{};
+    auto logInAllAtOnce = [&]() {
+      auto clients = std::vector<TestClient *>{};
+      for (const auto &name : names)
+        clients.push_back(new TestClient(TestClient::WithUsername(name)));
+      s.waitForUsers(NUM_USERS);
+      for (auto *client : clients) delete client;
+      WAIT_UNTIL(s.users().empty());
+    };
+    logInAllAtOnce();
+
+    BENCHMARK("They all log in at once, then out again") { logInAllAtOnce(); };
+  }
+}
+
+TEST_CASE("Saving a large world", "[.benchmark]") {
+  GIVEN("a synthetic world of many entities") {
+    const auto NUM_ENTITIES = 50000;
+    auto world = ShardedWorldFile{"World/benchmark", 10000.0};
+    world.generation(1);
+    for (auto i = 0; i != NUM_ENTITIES; ++i) {
+      auto entity = SavedEntity{};
+      entity.typeID = "tree";
+      entity.location = {i % 100 * 100.0, i / 100 * 20.0};
+      entity.serial = Serial::FromRaw(i + 1);
+      entity.gatherables.push_back({"wood", 5});
+      world.add(std::move(entity));
+    }
+
+    // The difference between these is the cost of durability.
+    BENCHMARK("Shards written in place, without syncing") {
+      const auto &shards = world.shards();
+      parallelFor(
+          shards.size(), [&](size_t i) { shards[i].publish(); }, "Benchmark");
+    };
+
+    BENCHMARK("Durable save: shards synced together, then committed") {
+      FileTransaction transaction;
+      world.publish(transaction);
+      return transaction.commit();
+    };
+
+    for (const auto &shard : world.shards())
+      std::remove(shard.filename().c_str());
+    std::remove(world.filename().c_str());
+    std::remove((world.filename() + ".previous").c_str());
+  }
+}
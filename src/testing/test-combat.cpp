@@ -1,3 +1,5 @@
+#include <algorithm>
+
 #include "../client/ClientNPC.h"
 #include "TestClient.h"
 #include "TestFixtures.h"
@@ -292,3 +294,74 @@ TEST_CASE_METHOD(ServerAndClientWithData, "XP from kills") {
     }
   }
 }
+
+TEST_CASE_METHOD(ServerAndClientWithData,
+                 "Removing an entity clears references to it") {
+  GIVEN("an NPC") {
+    useData(R"(
+      <npcType id="ant" maxHealth="1000" />
+    )");
+    auto &ant = server->addNPC("ant", {10, 15});
+
+    WHEN("the player targets it") {
+      client->sendMessage(CL_TARGET_ENTITY, makeArgs(ant.serial()));
+      WAIT_UNTIL(user->target() == &ant);
+
+      THEN("the NPC knows it's being referred to") {
+        CHECK(ant.references.numReferrers() > 0);
+      }
+
+      AND_WHEN("the NPC is removed") {
+        server->removeEntity(ant);
+
+        THEN("the player has no target") { CHECK(user->target() == nullptr); }
+      }
+    }
+  }
+}
+
+TEST_CASE_METHOD(TwoClientsWithData,
+                 "Links to a user are recorded against that user") {
+  GIVEN("Alice and Bob, a bear, a dog and a buff") {
+    useData(R"(
+      <npcType id="bear" maxHealth="1000" isNeutral="1" />
+      <npcType id="dog" maxHealth="1000" />
+      <buff id="blessed" />
+    )");
+    auto &bear = server->addNPC("bear", {100, 100});
+    auto &dog = server->addNPC("dog", {100, 100});
+
+    WHEN("each of them comes to refer to Alice") {
+      uBob->tagger = *uAlice;
+      bear.makeAwareOf(*uAlice);
+      uBob->applyBuff(server->getFirstBuff(), *uAlice);
+      dog.permissions.setPlayerOwner("Alice");
+      dog.followTarget(uAlice);
+
+      THEN("each of them is among Alice's referrers") {
+        const auto referrers = uAlice->references.referrers();
+        auto refersToAlice = [&](const Entity &entity) {
+          return std::find(referrers.begin(), referrers.end(), &entity) !=
+                 referrers.end();
+        };
+        CHECK(refersToAlice(*uBob));
+        CHECK(refersToAlice(bear));
+        CHECK(refersToAlice(dog));
+      }
+
+      AND_WHEN("Alice logs off") {
+        delete cAlice;
+        cAlice = nullptr;
+        WAIT_UNTIL(server->users().size() == 1);
+
+        THEN("none of them still refers to Alice") {
+          CHECK(dog.followTarget() == nullptr);
+          CHECK_FALSE(bear.isAwareOfAnyone());
+          CHECK_FALSE(uBob->tagger.asUser());
+          REQUIRE(uBob->buffs().size() == 1);
+          CHECK(uBob->buffs().front().caster() == nullptr);
+        }
+      }
+    }
+  }
+}
@@ -1,22 +1,176 @@
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <limits>
+#include <sstream>
+
+#include <windows.h>
+
 #include "../XmlReader.h"
+#include "../XmlStreamWriter.h"
 #include "../client/ClientNPCType.h"
+#include "../server/FileTransaction.h"
+#include "../server/ShardedWorldFile.h"
 #include "TestClient.h"
 #include "TestFixtures.h"
 #include "TestServer.h"
 #include "testing.h"
 
+extern Args cmdLineArgs;
+
 TEST_CASE("Read XML file with root only") {
   auto xr = XmlReader::FromFile("testing/empty.xml");
   for (auto elem : xr.getChildren("nonexistent_tag"))
     ;
 }
 
+// As the server reads its documents: from the file they were written to
+static void readBack(const XmlStreamWriter &document, XmlReader &xr) {
+  std::ofstream{document.filename()} << document.contents();
+  xr.newFile(document.filename());
+  std::remove(document.filename().c_str());
+}
+
+TEST_CASE("Attributes written by XmlStreamWriter are read back unchanged") {
+  const auto text = "a&b <c> \"d\" 'e'\nf\r\ng\th"s;
+  const auto negative = -42;
+  const auto largest = std::numeric_limits<unsigned long long>::max();
+  const auto smallest = std::numeric_limits<long long>::min();
+  const auto fraction = 12345.678901234;
+  const auto tiny = 1e-300;
+
+  // Given a document with those values
+  auto xw = XmlStreamWriter::Document("testing/round-trip.xml");
+  xw.openElement("values");
+  xw.setAttr("text", text);
+  xw.setAttr("negative", negative);
+  xw.setAttr("largest", largest);
+  xw.setAttr("smallest", smallest);
+  xw.setAttr("fraction", fraction);
+  xw.setAttr("tiny", tiny);
+  xw.closeElement();
+
+  // When it is read
+  auto xr = XmlReader{};
+  readBack(xw, xr);
+  REQUIRE(xr);
+  auto *elem = xr.findChild("values");
+  REQUIRE(elem);
+
+  // Then every value is as it was written
+  auto readText = ""s;
+  CHECK(xr.findAttr(elem, "text", readText));
+  CHECK(readText == text);
+  auto readNegative = 0;
+  CHECK(xr.findAttr(elem, "negative", readNegative));
+  CHECK(readNegative == negative);
+  auto readLargest = 0ull;
+  CHECK(xr.findAttr(elem, "largest", readLargest));
+  CHECK(readLargest == largest);
+  auto readSmallest = 0ll;
+  CHECK(xr.findAttr(elem, "smallest", readSmallest));
+  CHECK(readSmallest == smallest);
+  auto readFraction = 0.0;
+  CHECK(xr.findAttr(elem, "fraction", readFraction));
+  CHECK(readFraction == fraction);
+  auto readTiny = 0.0;
+  CHECK(xr.findAttr(elem, "tiny", readTiny));
+  CHECK(readTiny == tiny);
+}
+
+TEST_CASE("Nested elements written by XmlStreamWriter are read back") {
+  auto writeFamily = [](XmlStreamWriter &xw, const std::string &name) {
+    xw.openElement("parent");
+    xw.setAttr("name", name);
+    xw.openElement("child");
+    xw.setAttr("name", name + "'s first\nchild"s);
+    xw.openElement("grandchild");
+    xw.closeElement();
+    xw.closeElement();
+    xw.openElement("child");
+    xw.closeElement();
+    xw.closeElement();
+  };
+  auto checkFamily = [](TiXmlElement *parent, const std::string &name) {
+    REQUIRE(parent);
+    auto readName = ""s;
+    CHECK(XmlReader::findAttr(parent, "name", readName));
+    CHECK(readName == name);
+    auto children = XmlReader::getChildren("child", parent);
+    REQUIRE(children.size() == 2);
+    CHECK(XmlReader::findAttr(children[0], "name", readName));
+    CHECK(readName == name + "'s first\nchild"s);
+    CHECK(XmlReader::findChild("grandchild", children[0]));
+    CHECK(XmlReader::getAllChildren(children[1]).empty());
+  };
+
+  SECTION("As a document") {
+    auto xw = XmlStreamWriter::Document("testing/round-trip.xml");
+    writeFamily(xw, "Alice");
+    writeFamily(xw, "Bob");
+
+    auto xr = XmlReader{};
+    readBack(xw, xr);
+    REQUIRE(xr);
+    auto parents = xr.getChildren("parent");
+    REQUIRE(parents.size() == 2);
+    checkFamily(parents[0], "Alice");
+    checkFamily(parents[1], "Bob");
+  }
+
+  SECTION("As records, one per line") {
+    auto xw = XmlStreamWriter::Records("testing/round-trip.log");
+    writeFamily(xw, "Alice");
+    writeFamily(xw, "Bob");
+
+    auto lines = std::vector<std::string>{};
+    auto stream = std::istringstream{xw.contents()};
+    auto line = ""s;
+    while (std::getline(stream, line)) lines.push_back(line);
+    REQUIRE(lines.size() == 2);
+
+    // Each line is read as the server reads its change log
+    const auto names = std::vector<std::string>{"Alice", "Bob"};
+    for (auto i = 0; i != 2; ++i) {
+      auto xr = XmlReader::FromString(lines[i]);
+      REQUIRE(xr);
+      checkFamily(xr.findChild("parent"), names[i]);
+    }
+  }
+}
+
 TEST_CASE("Invalid items are removed") {
   TestServer s = TestServer::WithData("fake_item");
   auto it = s.items().find(ServerItem("fakeStone"));
   CHECK(it == s.items().end());
 }
 
+TEST_CASE("Types can be found by ID") {
+  GIVEN("an object type and an item") {
+    auto s = TestServer::WithDataString(R"(
+      <objectType id="box" />
+      <item id="rock" />
+    )");
+
+    THEN("the server can find them, and nothing else") {
+      CHECK(s->findObjectTypeByID("box") != nullptr);
+      CHECK(s->findItem("rock") != nullptr);
+      CHECK(s->findItem("paper") == nullptr);
+    }
+
+    WHEN("more data is loaded while the server is running") {
+      s.loadDataFromString(R"(
+        <item id="paper" />
+      )");
+
+      THEN("both old and new items can be found") {
+        CHECK(s->findItem("rock") != nullptr);
+        CHECK(s->findItem("paper") != nullptr);
+      }
+    }
+  }
+}
+
 TEST_CASE("No crash on bad data") {
   TestServer s = TestServer::WithData("this_doesnt_exist");
 }
@@ -241,6 +395,139 @@ TEST_CASE("Existing users load at the correct location") {
   }
 }
 
+TEST_CASE("A damaged account record left by a crash is discarded") {
+  // Given Alice has moved to (15, 15) and logged out
+  {
+    auto s = TestServer{};
+    auto c = TestClient::WithUsername("Alice");
+    s.waitForUsers(1);
+    s.getFirstUser().location({15, 15});
+  }
+
+  // And the server crashed while appending a newer version of her data
+  {
+    auto store =
+        std::ofstream{"testing/users/accounts.dat",
+                      std::ios_base::app | std::ios_base::binary};
+    const char partialRecord[] = "\x05\0\0\0\xff\xff\0\0Alice<root>";
+    store.write(partialRecord, sizeof(partialRecord) - 1);
+  }
+
+  // When the server restarts and she logs back in
+  auto s = TestServer::KeepingOldData();
+  auto c = TestClient::WithUsername("Alice");
+  s.waitForUsers(1);
+
+  // Then she has her last complete save
+  CHECK(s.getFirstUser().location() == MapPoint{15, 15});
+}
+
+// Every type loaded, with the types it refers to, in a fixed order
+static std::vector<std::string> describeLoadedData(TestServer &s) {
+  auto lines = std::vector<std::string>{};
+  auto describeMaterials = [](std::string &line, const ItemSet &materials) {
+    for (const auto &pair : materials)
+      line += " needs "s + pair.first->id() + " x"s + toString(pair.second);
+  };
+
+  for (const auto &item : s.items()) {
+    auto line = "item "s + item.id();
+    if (item.constructsObject())
+      line += " constructs "s + item.constructsObject()->id();
+    if (item.returnsOnConstruction())
+      line += " returns "s + item.returnsOnConstruction()->id();
+    lines.push_back(line);
+  }
+  for (const auto *type : s.objectTypes()) {
+    auto line = "object "s + type->id();
+    describeMaterials(line, type->materials());
+    lines.push_back(line);
+  }
+  for (const auto &recipe : s.recipes()) {
+    auto line = "recipe "s + recipe.id();
+    if (recipe.product()) line += " makes "s + recipe.product()->id();
+    describeMaterials(line, recipe.materials());
+    lines.push_back(line);
+  }
+
+  std::sort(lines.begin(), lines.end());
+  return lines;
+}
+
+TEST_CASE("Game data loads the same in parallel as serially", "[slow]") {
+  cmdLineArgs.add("nospawn");
+
+  // Given the game data was loaded one file at a time
+  cmdLineArgs.add("load-data-serially");
+  auto serialResult = std::vector<std::string>{};
+  {
+    auto s = TestServer::WithData("../../Data");
+    serialResult = describeLoadedData(s);
+  }
+  cmdLineArgs.remove("load-data-serially");
+  CHECK_FALSE(serialResult.empty());
+
+  // When it is loaded in parallel
+  auto s = TestServer::WithData("../../Data");
+
+  // Then the same types are loaded, with the same references between them
+  CHECK(describeLoadedData(s) == serialResult);
+
+  cmdLineArgs.remove("nospawn");
+}
+
+TEST_CASE("Changed game data can be reloaded while the server runs") {
+  const auto itemsFile = "testing/data/reloading/items.xml"s;
+  auto writeApple = [&](const std::string &stackSize) {
+    auto file = std::ofstream{itemsFile};
+    file << "<root>\n<item id=\"apple\" name=\"Apple\" stackSize=\""
+         << stackSize << "\" />\n</root>\n";
+  };
+
+  // Given apples stack to 5
+  writeApple("5");
+  auto s = TestServer::WithData("reloading");
+  const auto &apple = s.findItem("apple");
+  CHECK(apple.stackSize() == 5);
+
+  // When the data file is changed so that they stack to 50, and reloaded
+  writeApple("50");
+  s->reloadData();
+
+  // Then the existing item type stacks to 50
+  WAIT_UNTIL(apple.stackSize() == 50);
+  CHECK(&s.findItem("apple") == &apple);
+
+  writeApple("5");
+}
+
+TEST_CASE("Reloading an object type updates its objects' capabilities") {
+  const auto objectsFile = "testing/data/reloading/objects.xml"s;
+  auto writeDoor = [&](bool isGate) {
+    auto file = std::ofstream{objectsFile};
+    file << "<root>\n<objectType id=\"door\""
+         << (isGate ? " isGate=\"1\"" : "") << " />\n</root>\n";
+  };
+
+  // Given a door that isn't a gate
+  writeDoor(false);
+  auto s = TestServer::WithData("reloading");
+  auto &door = s.addObject("door", {10, 10});
+  CHECK_FALSE(door.hasCapability(Entity::IS_GATE));
+
+  // When the data file is changed to make doors gates, and reloaded
+  writeDoor(true);
+  s->reloadData();
+
+  // Then the existing door is a gate
+  WAIT_UNTIL(door.hasCapability(Entity::IS_GATE));
+
+  // And when that change is undone, it stops being one
+  writeDoor(false);
+  s->reloadData();
+  WAIT_UNTIL(!door.hasCapability(Entity::IS_GATE));
+}
+
 TEST_CASE("The map can be loaded from a string") {
   GIVEN("a 2x2 map specified by string") {
     auto data = R"(
@@ -587,3 +874,172 @@ TEST_CASE_METHOD(ServerAndClientWithData,
     }
   }
 }
+
+TEST_CASE("Changes logged since the last full save are replayed on load") {
+  auto data = R"(
+    <objectType id="box" />
+  )";
+
+  // Given a box in the last full save of the world
+  {
+    auto s = TestServer::WithDataString(data);
+    s.addObject("box", {10, 10});
+  }
+  auto savedWorld = ShardedWorldFile{"World/entities"};
+  REQUIRE(savedWorld.load());
+  auto savedEntities = std::vector<SavedEntity>{};
+  for (const auto &shard : savedWorld.shards())
+    for (const auto &entity : shard.entities()) savedEntities.push_back(entity);
+  REQUIRE(savedEntities.size() == 1);
+  auto serial = savedEntities.front().serial;
+  auto generation = savedWorld.generation();
+
+  // And a change log that removes it and adds another
+  {
+    auto log = std::ofstream{"World/entities.log", std::ios_base::app};
+    log << R"(<removed serial=")" << serial << R"(" generation=")"
+        << generation << R"(" />)" << std::endl;
+    log << R"(<object id="box" x="30" y="30" serial="1000" generation=")"
+        << generation << R"(" />)" << std::endl;
+  }
+
+  // When the server restarts
+  auto s = TestServer::WithDataStringAndKeepingOldData(data);
+
+  // Then only the logged box exists
+  WAIT_UNTIL(s.entities().size() == 1);
+  CHECK(s.getFirstObject().location() == MapPoint{30, 30});
+}
+
+TEST_CASE("A damaged world shard loses only the entities in its region") {
+  auto data = R"(
+    <terrain index="." id="grass" />
+    <list id="default" default="1" >
+      <allow id="grass" />
+    </list>
+    <size x="2" y="2" />
+    <row y="0" terrain=".." />
+    <row y="1" terrain=".." />
+    <objectType id="box" />
+  )";
+
+  // Given boxes at the top and bottom of the world were saved
+  {
+    auto s = TestServer::WithDataString(data);
+    s.addObject("box", {10, 10});
+    s.addObject("box", {10, 60});
+  }
+
+  // And the shard holding the bottom one was damaged
+  auto savedWorld = ShardedWorldFile{"World/entities"};
+  REQUIRE(savedWorld.load());
+  auto numShardsDamaged = 0;
+  for (const auto &shard : savedWorld.shards()) {
+    if (shard.entities().empty()) continue;
+    if (shard.entities().front().location.y < 50) continue;
+    auto file = std::ofstream{shard.filename(), std::ios_base::binary};
+    file << "garbage";
+    ++numShardsDamaged;
+  }
+  REQUIRE(numShardsDamaged == 1);
+
+  // And there is no earlier save to fall back on
+  remove("World/entities.manifest.previous");
+
+  // When the server restarts
+  auto s = TestServer::WithDataStringAndKeepingOldData(data);
+
+  // Then the top box is still there
+  WAIT_UNTIL(s.entities().size() == 1);
+  CHECK(s.getFirstObject().location() == MapPoint{10, 10});
+}
+
+TEST_CASE("A damaged world save falls back on the one before it") {
+  auto data = R"(
+    <objectType id="box" />
+  )";
+
+  // Given a box was saved
+  {
+    auto s = TestServer::WithDataString(data);
+    s.addObject("box", {10, 10});
+  }
+
+  // And then another box was saved with it
+  {
+    auto s = TestServer::WithDataStringAndKeepingOldData(data);
+    s.addObject("box", {20, 20});
+  }
+
+  // And that latest save was damaged
+  {
+    auto latest = ShardedWorldFile{"World/entities"};
+    REQUIRE(latest.load());
+    for (const auto &shard : latest.shards()) {
+      if (shard.entities().empty()) continue;
+      auto file = std::ofstream{shard.filename(), std::ios_base::binary};
+      file << "garbage";
+    }
+  }
+
+  // When the server restarts
+  auto s = TestServer::WithDataStringAndKeepingOldData(data);
+
+  // Then only the first box exists
+  WAIT_UNTIL(s.entities().size() == 1);
+  CHECK(s.getFirstObject().location() == MapPoint{10, 10});
+}
+
+TEST_CASE("Nothing is appended once a file in a save can't be replaced") {
+  auto s = TestServer{};  // To report the failure to
+
+  // Given a file to be replaced can't be, as a directory is in its way
+  const auto blocked = "World/blocked"s;
+  CreateDirectory(blocked.c_str(), nullptr);
+  const auto log = "World/blocked.log"s;
+  remove(log.c_str());
+
+  // When a save replacing it and then appending to a log is committed
+  {
+    FileTransaction transaction;
+    transaction.replace(blocked, "contents");
+    transaction.append(log, "entry\n");
+    CHECK_FALSE(transaction.commit());
+  }
+
+  // Then nothing was appended
+  CHECK_FALSE(std::ifstream{log});
+
+  RemoveDirectory(blocked.c_str());
+}
+
+TEST_CASE("The saved world can be exported to and imported from XML") {
+  auto data = R"(
+    <objectType id="box" />
+  )";
+
+  // Given the world was saved with an XML copy
+  cmdLineArgs.add("export-world-xml");
+  {
+    auto s = TestServer::WithDataString(data);
+    s.addObject("box", {10, 10});
+  }
+  cmdLineArgs.remove("export-world-xml");
+  auto xr = XmlReader::FromFile("World/entities.world");
+  CHECK(xr.findChild("object") != nullptr);
+
+  // When the copy is edited to move the box
+  {
+    auto xmlCopy = std::ofstream{"World/entities.world"};
+    xmlCopy << R"(<root><object id="box" x="50" y="50" /></root>)";
+  }
+
+  // And the server restarts from the copy
+  cmdLineArgs.add("import-world-xml");
+  auto s = TestServer::WithDataStringAndKeepingOldData(data);
+  cmdLineArgs.remove("import-world-xml");
+
+  // Then the box is where the copy put it
+  WAIT_UNTIL(s.entities().size() == 1);
+  CHECK(s.getFirstObject().location() == MapPoint{50, 50});
+}
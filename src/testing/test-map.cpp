@@ -1,6 +1,8 @@
+#include "../server/ActiveRegions.h"
 #include "TestClient.h"
 #include "TestServer.h"
 
+extern Args cmdLineArgs;
 extern Renderer renderer;
 
 TEST_CASE("Objects show up on the map when a client logs in") {
@@ -122,3 +124,38 @@ TEST_CASE("When a player declares war, his map pin changes color",
   CHECK(bluePinExists);
   CHECK(redPinExists);
 }
+
+TEST_CASE("Regions are active only while users are near them") {
+  cmdLineArgs.remove("all-regions-active");
+  const auto regionNearOrigin = MapPoint{500, 500};
+  auto regions = ActiveRegions{};
+
+  // Given a user in the region at the origin
+  regions.update({regionNearOrigin});
+  CHECK(regions.isActive(regionNearOrigin));
+  CHECK_FALSE(regions.isActive({5000, 5000}));
+
+  SECTION("A region stays active while a user is just out of range") {
+    // When the user moves past the activation distance, but not past the
+    // deactivation distance
+    regions.update({MapPoint{2200, 500}});
+
+    // Then the region is still active
+    CHECK(regions.isActive(regionNearOrigin));
+
+    // But it wouldn't have been activated from there
+    auto freshRegions = ActiveRegions{};
+    freshRegions.update({MapPoint{2200, 500}});
+    CHECK_FALSE(freshRegions.isActive(regionNearOrigin));
+  }
+
+  SECTION("A region is deactivated once users are far enough away") {
+    // When the user moves past the deactivation distance
+    regions.update({MapPoint{2600, 500}});
+
+    // Then the region is inactive
+    CHECK_FALSE(regions.isActive(regionNearOrigin));
+  }
+
+  cmdLineArgs.add("all-regions-active");
+}
@@ -0,0 +1,107 @@
+#include <sstream>
+
+#include "TestClient.h"
+#include "TestServer.h"
+#include "testing.h"
+
+static std::string publishedTotals(TestServer &s) {
+  auto oss = std::ostringstream{};
+  s.publishedStats().writeTotals(oss);
+  return oss.str();
+}
+
+static bool includes(const std::string &totals, const std::string &line) {
+  return totals.find(line) != std::string::npos;
+}
+
+static std::string accountsAtLevel(Level level, int count) {
+  return "accountsByLevel: {\"" + std::to_string(level) +
+         "\": " + std::to_string(count) + ",},";
+}
+
+TEST_CASE("Published totals follow a user through login, progress and logout") {
+  const auto data = R"(
+    <item id="brick" />
+    <recipe id="brick" />
+  )"s;
+  auto s = TestServer::WithDataString(data);
+
+  auto startingLevel = Level{0};
+  {
+    // When Alice logs in
+    auto c = TestClient::WithUsernameAndDataString("Alice", data);
+    s.waitForUsers(1);
+    auto &alice = s.getFirstUser();
+    startingLevel = alice.level();
+
+    // Then she is counted once, at her level, knowing no recipes
+    auto totals = publishedTotals(s);
+    CHECK(includes(totals, "accounts: 1,"));
+    CHECK(includes(totals, accountsAtLevel(startingLevel, 1)));
+    CHECK(includes(totals, "recipesKnown: 0,"));
+
+    // When she learns a recipe and levels up
+    alice.addRecipe("brick");
+    alice.levelUp();
+
+    // Then the totals move with her
+    totals = publishedTotals(s);
+    CHECK(includes(totals, "accounts: 1,"));
+    CHECK(includes(totals, accountsAtLevel(startingLevel + 1, 1)));
+    CHECK(includes(totals, "recipesKnown: 1,"));
+    CHECK(s.publishedStats().offlineUserEntries().empty());
+  }
+
+  // When she logs out
+  WAIT_UNTIL(s.users().empty());
+
+  // Then she is still counted, with her progress, and listed as offline
+  auto totals = publishedTotals(s);
+  CHECK(includes(totals, "accounts: 1,"));
+  CHECK(includes(totals, accountsAtLevel(startingLevel + 1, 1)));
+  CHECK(includes(totals, "recipesKnown: 1,"));
+  CHECK(includes(s.publishedStats().offlineUserEntries(), "\"Alice\""));
+
+  // When she logs back in
+  auto c = TestClient::WithUsernameAndDataString("Alice", data);
+  s.waitForUsers(1);
+
+  // Then she isn't counted twice, and is no longer listed as offline
+  totals = publishedTotals(s);
+  CHECK(includes(totals, "accounts: 1,"));
+  CHECK(includes(totals, accountsAtLevel(startingLevel + 1, 1)));
+  CHECK(includes(totals, "recipesKnown: 1,"));
+  CHECK(s.publishedStats().offlineUserEntries().empty());
+}
+
+TEST_CASE("Published totals count each account separately") {
+  auto s = TestServer{};
+
+  // Given Alice and Bob are online
+  auto cAlice = TestClient::WithUsername("Alice");
+  {
+    auto cBob = TestClient::WithUsername("Bob");
+    s.waitForUsers(2);
+    CHECK(includes(publishedTotals(s), "accounts: 2,"));
+
+    // When Bob levels up
+    auto &bob = s.findUser("Bob");
+    const auto startingLevel = bob.level();
+    bob.levelUp();
+
+    // Then one account is at each level
+    auto totals = publishedTotals(s);
+    CHECK(includes(totals, "\"" + std::to_string(startingLevel) + "\": 1,"));
+    CHECK(includes(totals,
+                   "\"" + std::to_string(startingLevel + 1) + "\": 1,"));
+  }
+
+  // When Bob logs out
+  s.waitForUsers(1);
+
+  // Then both accounts are still counted
+  CHECK(includes(publishedTotals(s), "accounts: 2,"));
+  const auto &offline = s.publishedStats().offlineUserEntries();
+  CHECK(includes(offline, "\"Bob\""));
+  CHECK_FALSE(includes(offline, "\"Alice\""));
+}
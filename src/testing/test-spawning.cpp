@@ -2,6 +2,8 @@
 #include "TestServer.h"
 #include "testing.h"
 
+extern Args cmdLineArgs;
+
 TEST_CASE("Simple spawner") {
   GIVEN("a small object spawner") {
     auto data = R"(
@@ -244,6 +246,72 @@ TEST_CASE("Cached terrain for spawning") {
   }
 }
 
+TEST_CASE("Initial spawns from several spawners don't overlap") {
+  // Given two overlapping spawners of solid rocks
+  auto data = R"(
+      <objectType id="rock" >
+        <collisionRect x="-5" y="-5" w="10" h="10" />
+      </objectType>
+      <spawnPoint y="150" x="150" type="rock" quantity="20" radius="100" />
+      <spawnPoint y="150" x="200" type="rock" quantity="20" radius="100" />
+    )";
+
+  // When the server starts
+  auto s = TestServer::WithDataString(data);
+
+  // Then every rock has spawned
+  CHECK(s.entities().size() == 40);
+
+  // And no two overlap
+  for (const auto *a : s.entities())
+    for (const auto *b : s.entities()) {
+      if (a == b) continue;
+      CHECK_FALSE(a->collisionRect().overlaps(b->collisionRect()));
+    }
+}
+
+TEST_CASE("A terrain tile index finds the same tiles as a full scan") {
+  // Given a map with water scattered across it
+  auto data = R"(
+      <terrain index="." id="grass" />
+      <terrain index="w" id="water" />
+      <list id="default" default="1" >
+        <allow id="grass" />
+      </list>
+      <list id="water" >
+        <allow id="water" />
+      </list>
+      <size x="50" y="50" />
+    )"s;
+  for (auto y = 0; y != 50; ++y) {
+    auto row = std::string(50, '.');
+    for (auto x = 0; x != 50; ++x)
+      if ((7 * x + 3 * y) % 5 == 0) row[x] = 'w';
+    data += "<row y=\""s + std::to_string(y) + "\" terrain=\"" + row + "\" />";
+  }
+  auto s = TestServer::WithDataString(data);
+  const auto &map = s->map();
+  const auto &water = *TerrainList::findList("water");
+
+  // When it is indexed
+  auto index = TerrainTileIndex{map, water};
+
+  // Then the water tiles near any point are the ones a full scan would find
+  for (auto centre : {MapPoint{0, 0}, MapPoint{400, 700}, MapPoint{1590, 1590},
+                      MapPoint{-100, 800}})
+    for (auto radius : {0.0, 20.0, 150.0, 2000.0}) {
+      auto expected = TerrainTileIndex::Tiles{};
+      for (auto y = size_t{0}; y != map.height(); ++y)
+        for (auto x = size_t{0}; x != map.width(); ++x) {
+          if (!water.allows(map.at(x, y))) continue;
+          if (distance(Map::getTileRect(x, y), MapRect{centre}) > radius)
+            continue;
+          expected.push_back(map.to1D(x, y));
+        }
+      CHECK(index.tilesNear(centre, radius) == expected);
+    }
+}
+
 TEST_CASE("Dead objects respawn") {
   GIVEN("an object that respawns instantly") {
     auto data = R"(
@@ -261,3 +329,30 @@ TEST_CASE("Dead objects respawn") {
     }
   }
 }
+
+TEST_CASE("Respawns wait until a user is nearby") {
+  cmdLineArgs.remove("all-regions-active");
+
+  // Given an object that respawns instantly, and no users
+  auto data = R"(
+    <objectType id="whackamole" />
+    <spawnPoint y="10" x="10" type="whackamole" quantity="1" radius="10" respawnTime="0" />
+  )";
+  auto s = TestServer::WithDataString(data);
+  auto &mole = s.getFirstObject();
+
+  // When it dies
+  mole.kill();
+
+  // Then it doesn't respawn
+  REPEAT_FOR_MS(200);
+  CHECK(s.entities().size() == 1);
+
+  // When a user arrives
+  auto c = TestClient::WithDataString(data);
+
+  // Then it respawns
+  WAIT_UNTIL(s.entities().size() == 2);
+
+  cmdLineArgs.add("all-regions-active");
+}
@@ -28,7 +28,7 @@ TEST_CASE("Large map is read accurately", "[.slow]") {
     for (size_t y = 0; y != 315; ++y) {
       CAPTURE(x);
       CAPTURE(y);
-      REQUIRE(s->map()[x][y] == 'G');
+      REQUIRE(s->map().at(x, y) == 'G');
     }
 }
 
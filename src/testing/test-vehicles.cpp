@@ -112,3 +112,31 @@ TEST_CASE("If a vehicle dies stop driving it") {
     }
   }
 }
+
+TEST_CASE("Drivers are still driving after logging back in") {
+  GIVEN("Alice is driving a vehicle") {
+    auto data = R"(
+      <objectType id="horse" isVehicle="1" />
+    )";
+    auto s = TestServer::WithDataString(data);
+    auto &horse = s.addObject("horse", {10, 15});
+    {
+      auto c = TestClient::WithUsernameAndDataString("Alice", data);
+      s.waitForUsers(1);
+      c.sendMessage(CL_MOUNT, makeArgs(horse.serial()));
+      WAIT_UNTIL(s.getFirstUser().isDriving());
+    }
+
+    WHEN("she logs out and back in") {
+      WAIT_UNTIL(s.users().empty());
+      auto c = TestClient::WithUsernameAndDataString("Alice", data);
+      s.waitForUsers(1);
+
+      THEN("she is driving the same vehicle") {
+        const auto &user = s.getFirstUser();
+        CHECK(user.driving() == horse.serial());
+        CHECK(s.entities().findVehicleDrivenBy(user) == &horse);
+      }
+    }
+  }
+}
@@ -33,6 +33,9 @@ int main(int argc, char* argv[]) {
   cmdLineArgs.add("user-files-path", "testing/users");
   cmdLineArgs.add("hideLoadingScreen");
   cmdLineArgs.add("debug");
+  // Most tests have no users near their NPCs.
+  cmdLineArgs.add("all-regions-active");
+  cmdLineArgs.add("ai-at-full-rate");
 
   renderer.init();
 
@@ -80,11 +80,12 @@ MapPoint extrapolate(const MapPoint &a, const MapPoint &b, double dist) {
   return {a.x + xNorm * dist, a.y + yNorm * dist};
 }
 
-MapPoint getRandomPointInCircle(const MapPoint &centre, double radius) {
+MapPoint getRandomPointInCircle(const MapPoint &centre, double radius,
+                                const RandomSource &random) {
   auto p = centre;
   if (radius != 0) {
-    radius *= sqrt(randDouble());
-    double angle = randDouble() * 2 * PI;
+    radius *= sqrt(random());
+    double angle = random() * 2 * PI;
     p.x += cos(angle) * radius;
     p.y -= sin(angle) * radius;
   }
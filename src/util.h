@@ -2,6 +2,7 @@
 #define UTIL_H
 
 #include <cstdlib>
+#include <functional>
 #include <set>
 #include <sstream>
 #include <vector>
@@ -24,6 +25,8 @@ inline int toInt(double d) {
 }
 
 inline double randDouble() { return (1.0 * rand()) / RAND_MAX; }
+// Something that, like randDouble(), gives numbers in [0, 1]
+using RandomSource = std::function<double()>;
 
 bool almostEquals(double a, double b);
 
@@ -46,7 +49,8 @@ MapPoint interpolate(const MapPoint &a, const MapPoint &b, double dist);
 // dist must exceed the distance between a and b.
 MapPoint extrapolate(const MapPoint &a, const MapPoint &b, double dist);
 
-MapPoint getRandomPointInCircle(const MapPoint &centre, double radius);
+MapPoint getRandomPointInCircle(const MapPoint &centre, double radius,
+                                const RandomSource &random = randDouble);
 
 inline int str2int(const std::string str) {
   std::istringstream iss(str);